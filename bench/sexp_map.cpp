@@ -0,0 +1,122 @@
+/* Lookup and insert throughput of SexpMap against std::unordered_map with
+   the number of live keys the promise map holds on large traces. The keys
+   are spaced like R nodes on their pages and visited in random order, so
+   the lookups miss the cache the way the probes do.
+
+   make bench
+   bench/sexp_map [live key count] */
+
+#include "SexpMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/* the size of an R node, so that keys have the alignment of real ones. */
+const std::size_t NODE_SIZE = 56;
+
+static std::vector<SEXP> create_keys(std::size_t count, std::mt19937_64& rng) {
+    std::vector<SEXP> keys(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        keys[i] = reinterpret_cast<SEXP>(NODE_SIZE * (i + 1));
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+template <typename F>
+static double measure(F f) {
+    const auto begin = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+static void report(const char* map,
+                   const char* operation,
+                   std::size_t count,
+                   double seconds) {
+    std::printf("%-20s %-8s %10.1f Mops/s\n",
+                map,
+                operation,
+                count / seconds / 1e6);
+}
+
+/* inserts all keys, looks them up in another random order, looks up as
+   many absent keys and finally replaces half of the keys, like promises
+   being reclaimed and created while the map stays full. */
+template <typename Map>
+static std::size_t run(const char* name,
+                       Map& map,
+                       const std::vector<SEXP>& keys,
+                       const std::vector<SEXP>& lookups,
+                       const std::vector<SEXP>& absent_keys) {
+    std::size_t checksum = 0;
+
+    report(name, "insert", keys.size(), measure([&] {
+               for (std::size_t i = 0; i < keys.size(); ++i) {
+                   map.insert({keys[i], static_cast<int>(i)});
+               }
+           }));
+
+    report(name, "hit", lookups.size(), measure([&] {
+               for (SEXP key: lookups) {
+                   checksum += map.find(key)->second;
+               }
+           }));
+
+    report(name, "miss", absent_keys.size(), measure([&] {
+               for (SEXP key: absent_keys) {
+                   checksum += map.find(key) == map.end();
+               }
+           }));
+
+    const std::size_t churn_count = keys.size() / 2;
+
+    report(name, "churn", churn_count, measure([&] {
+               for (std::size_t i = 0; i < churn_count; ++i) {
+                   map.erase(keys[i]);
+                   map.insert({absent_keys[i], static_cast<int>(i)});
+               }
+           }));
+
+    return checksum;
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t count =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::mt19937_64 rng(42);
+
+    /* the absent keys are drawn from the same address range as the live
+       ones, with an offset that keeps them distinct. */
+    std::vector<SEXP> all_keys = create_keys(2 * count, rng);
+    std::vector<SEXP> keys(all_keys.begin(), all_keys.begin() + count);
+    std::vector<SEXP> absent_keys(all_keys.begin() + count, all_keys.end());
+    std::vector<SEXP> lookups(keys);
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+
+    std::size_t checksum = 0;
+
+    /* the SexpMap constructor takes a slot count and the map grows past a
+       load factor of 1/2, so it is given twice the slots to hold count keys
+       without rehashing, like the std::unordered_map below. */
+    {
+        SexpMap<int> map(2 * count);
+        checksum += run("SexpMap", map, keys, lookups, absent_keys);
+    }
+
+    {
+        std::unordered_map<SEXP, int> map(count);
+        checksum += run("std::unordered_map", map, keys, lookups, absent_keys);
+    }
+
+    std::printf("checksum %zu\n", checksum);
+
+    return 0;
+}
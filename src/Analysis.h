@@ -0,0 +1,93 @@
+#ifndef DYNAMISMTRACER_ANALYSIS_H
+#define DYNAMISMTRACER_ANALYSIS_H
+
+#include "Event.h"
+
+#include <string>
+#include <vector>
+
+/* The analyses that can be enabled when creating the tracer. Each analysis
+ owns a set of output tables and declares the probes it consumes. Only the
+ probes required by at least one enabled analysis are attached. */
+enum class Analysis {
+    EventCounts = 0,
+    CallSummaries,
+    FunctionDefinitions,
+    Arguments,
+    Promises,
+    ProbeOverhead,
+    COUNT
+};
+
+inline std::string to_string(const Analysis analysis) {
+    switch (analysis) {
+    case Analysis::EventCounts:
+        return "event_counts";
+    case Analysis::CallSummaries:
+        return "call_summaries";
+    case Analysis::FunctionDefinitions:
+        return "function_definitions";
+    case Analysis::Arguments:
+        return "arguments";
+    case Analysis::Promises:
+        return "promises";
+    case Analysis::ProbeOverhead:
+        return "probe_overhead";
+    case Analysis::COUNT:
+        return "unknown_analysis";
+    }
+
+    return "unknown_analysis";
+}
+
+/* returns Analysis::COUNT if the name does not denote an analysis. */
+inline Analysis string_to_analysis(const std::string& name) {
+    for (int i = 0; i < static_cast<int>(Analysis::COUNT); ++i) {
+        if (to_string(static_cast<Analysis>(i)) == name) {
+            return static_cast<Analysis>(i);
+        }
+    }
+    return Analysis::COUNT;
+}
+
+inline const std::vector<Event>& get_required_probes(const Analysis analysis) {
+    /* event counts only need the eval probe for themselves. the counts of
+     the other events are collected by whichever probes the other analyses
+     attach. */
+    static const std::vector<Event> event_count_probes{Event::EvalEntry};
+
+    /* the probes that maintain the call stack, and with it, the calls, their
+     arguments and the functions they invoke. gc_unmark is required to evict
+     the state of reclaimed objects. */
+    static const std::vector<Event> call_stack_probes{Event::ClosureEntry,
+                                                      Event::ClosureExit,
+                                                      Event::BuiltinEntry,
+                                                      Event::BuiltinExit,
+                                                      Event::SpecialEntry,
+                                                      Event::SpecialExit,
+                                                      Event::ContextEntry,
+                                                      Event::ContextJump,
+                                                      Event::ContextExit,
+                                                      Event::GcUnmark};
+
+    static const std::vector<Event> no_probes;
+
+    switch (analysis) {
+    case Analysis::EventCounts:
+        return event_count_probes;
+    /* probe overhead times the probes attached for the other analyses. */
+    case Analysis::ProbeOverhead:
+        return no_probes;
+    case Analysis::CallSummaries:
+    case Analysis::FunctionDefinitions:
+    case Analysis::Arguments:
+    case Analysis::Promises:
+        return call_stack_probes;
+    case Analysis::COUNT:
+        return no_probes;
+    }
+
+    return no_probes;
+}
+
+#endif /* DYNAMISMTRACER_ANALYSIS_H */
@@ -3,7 +3,7 @@
 #include "Function.h"
 
 Call::Call(const call_id_t id,
-           const std::string& function_name,
+           const char* function_name,
            const SEXP environment,
            Function* function,
            const SEXP args)
@@ -18,13 +18,9 @@ Call::Call(const call_id_t id,
     , S3_method_(false)
     , S4_method_(false)
     , callee_counter_(0)
-    , dynamic_call_(false) {
-    wrapper_ = function_->is_dot_internal() || function_->is_dot_primitive() ||
-               function_->is_dot_c() || function_->is_dot_fortran() ||
-               function_->is_dot_external() || function_->is_dot_external2() ||
-               function_->is_dot_call() ||
-               function_->is_dot_external_graphics() ||
-               function_->is_dot_call_graphics();
+    , dynamic_call_(false)
+    , forced_positions_(0) {
+    wrapper_ = function_->is_native_interface();
 
     arguments_.reserve(std::max(function_->get_formal_parameter_count(), 0));
     force_order_.reserve(std::max(function_->get_formal_parameter_count(), 0));
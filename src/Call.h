@@ -6,6 +6,9 @@
 #include "Rinternals.h"
 #include "utilities.h"
 
+#include <algorithm>
+#include <cstdint>
+
 class Function;
 
 typedef std::vector<int> force_order_t;
@@ -14,7 +17,7 @@ class Call {
   public:
     /* defined in cpp file to get around cyclic dependency issues. */
     explicit Call(const call_id_t id,
-                  const std::string& function_name,
+                  const char* function_name,
                   const SEXP environment,
                   Function* function,
                   const SEXP args);
@@ -27,7 +30,8 @@ class Call {
         return args_;
     }
 
-    const std::string& get_function_name() const {
+    /* the name is interned by R and outlives the call. */
+    const char* get_function_name() const {
         return function_name_;
     }
 
@@ -87,13 +91,13 @@ class Call {
         return S4_method_;
     }
 
-    void analyze_callee(Call* callee) {
+    void analyze_callee(bool callee_wrapper) {
         ++callee_counter_;
         /* if a caller has more than one callee it is not a wrapper. */
         if (callee_counter_ > 1) {
             wrapper_ = false;
         } else {
-            wrapper_ = callee->is_wrapper();
+            wrapper_ = callee_wrapper;
         }
     }
 
@@ -109,9 +113,23 @@ class Call {
         return arguments_[actual_argument_position];
     }
 
+    /* the denoted value of an argument does not change its type once it is
+       bound, so the missing argument positions are collected as the
+       arguments are added. */
     void add_argument(Argument* argument) {
         arguments_.push_back(argument);
         ++actual_argument_count_;
+
+        if (argument->get_denoted_value()->is_missing()) {
+            int position = argument->get_formal_parameter_position();
+
+            /* this condition handles multiple missing values
+               in dot dot arguments. */
+            if (missing_argument_positions_.empty() ||
+                missing_argument_positions_.back() != position) {
+                missing_argument_positions_.push_back(position);
+            }
+        }
     }
 
     const pos_seq_t& get_force_order() const {
@@ -120,39 +138,32 @@ class Call {
 
     void set_force_order(int force_order) {
         force_order_ = {force_order};
+        forced_positions_ = 0;
+        mark_forced_(force_order);
     }
 
     void add_to_force_order(int formal_parameter_position) {
-        if (std::find(force_order_.begin(),
-                      force_order_.end(),
-                      formal_parameter_position) == force_order_.end()) {
-            force_order_.push_back(formal_parameter_position);
+        if (is_forced_(formal_parameter_position)) {
+            return;
         }
-    }
-
-    pos_seq_t get_missing_argument_positions() const {
-        pos_seq_t missing_argument_positions;
-        int position;
 
-        for (auto argument: arguments_) {
-            if (argument->get_denoted_value()->is_missing()) {
-                position = argument->get_formal_parameter_position();
+        force_order_.push_back(formal_parameter_position);
+        mark_forced_(formal_parameter_position);
+    }
 
-                /* this condition handles multiple missing values
-                   in dot dot arguments. */
-                if (missing_argument_positions.size() == 0 ||
-                    missing_argument_positions.back() != position) {
-                    missing_argument_positions.push_back(position);
-                }
-            }
-        }
+    const pos_seq_t& get_missing_argument_positions() const {
+        return missing_argument_positions_;
+    }
 
-        return missing_argument_positions;
+    /* for calls replayed from an event log, which have no arguments. */
+    void set_missing_argument_positions(
+        const pos_seq_t& missing_argument_positions) {
+        missing_argument_positions_ = missing_argument_positions;
     }
 
   private:
     const call_id_t id_;
-    const std::string function_name_;
+    const char* const function_name_;
     int actual_argument_count_;
     const SEXP environment_;
     const SEXP args_;
@@ -166,6 +177,30 @@ class Call {
     bool wrapper_;
     std::vector<Argument*> arguments_;
     pos_seq_t force_order_;
+    pos_seq_t missing_argument_positions_;
+    /* bit i is set if position i is in the force order. positions beyond
+       the width of the mask are looked up in the force order itself. */
+    std::uint64_t forced_positions_;
+
+    static const int FORCED_POSITION_MASK_WIDTH_ = 64;
+
+    static bool is_maskable_(int position) {
+        return position >= 0 && position < FORCED_POSITION_MASK_WIDTH_;
+    }
+
+    bool is_forced_(int position) const {
+        if (is_maskable_(position)) {
+            return forced_positions_ & (std::uint64_t(1) << position);
+        }
+        return std::find(force_order_.begin(), force_order_.end(), position) !=
+               force_order_.end();
+    }
+
+    void mark_forced_(int position) {
+        if (is_maskable_(position)) {
+            forced_positions_ |= std::uint64_t(1) << position;
+        }
+    }
 };
 
 #endif /* DYNAMISMTRACER_CALL_H */
@@ -2,18 +2,30 @@
 #define DYNAMISMTRACER_CALL_SUMMARY_H
 
 #include "Call.h"
+#include "hash.h"
+
+#include <cstdint>
 
 class CallSummary {
   public:
-    explicit CallSummary(const Call* const call) {
-        force_order_ = call->get_force_order();
-        missing_argument_positions_ = call->get_missing_argument_positions();
-        return_value_type_ = call->get_return_value_type();
-        jumped_ = call->is_jumped();
-        S3_method_ = call->is_S3_method();
-        S4_method_ = call->is_S4_method();
-        call_count_ = 1;
-        dynamic_call_count_ = call->is_dynamic_call();
+    explicit CallSummary(const pos_seq_t& force_order,
+                         const pos_seq_t& missing_argument_positions,
+                         sexptype_t return_value_type,
+                         bool jumped,
+                         bool S3_method,
+                         bool S4_method,
+                         bool dynamic_call,
+                         int weight)
+        : force_order_(force_order)
+        , missing_argument_positions_(missing_argument_positions)
+        , return_value_type_(return_value_type)
+        , jumped_(jumped)
+        , S3_method_(S3_method)
+        , S4_method_(S4_method)
+        , call_count_(weight)
+        , dynamic_call_count_(dynamic_call ? weight : 0)
+        , checkpointed_call_count_(0)
+        , checkpointed_dynamic_call_count_(0) {
     }
 
     const pos_seq_t& get_force_order() const {
@@ -48,17 +60,95 @@ class CallSummary {
         return dynamic_call_count_;
     }
 
-    bool try_to_merge(const Call* const call) {
-        if (is_mergeable_(call)) {
-            call_count_++;
-            if (call->is_dynamic_call()) {
-                dynamic_call_count_++;
+    /* the calls since the counts were last checkpointed. */
+    int get_call_count_delta() const {
+        return call_count_ - checkpointed_call_count_;
+    }
+
+    int get_dynamic_call_count_delta() const {
+        return dynamic_call_count_ - checkpointed_dynamic_call_count_;
+    }
+
+    /* the calls that the dynamic call summary has not reported. the
+       dynamic call summary is only reported once there is a dynamic call,
+       so its first report covers all calls before it. */
+    int get_dynamic_summary_call_count_delta() const {
+        return checkpointed_dynamic_call_count_ > 0 ? get_call_count_delta()
+                                                    : call_count_;
+    }
+
+    void checkpoint() {
+        checkpointed_call_count_ = call_count_;
+        checkpointed_dynamic_call_count_ = dynamic_call_count_;
+    }
+
+    /* a hash of the properties that decide whether two calls are summarized
+       together. calls with different fingerprints are never merged, calls
+       with equal fingerprints still have to be compared. */
+    static std::uint64_t
+    compute_fingerprint(const pos_seq_t& force_order,
+                        const pos_seq_t& missing_argument_positions,
+                        sexptype_t return_value_type,
+                        bool jumped,
+                        bool S3_method,
+                        bool S4_method) {
+        Hasher hasher;
+
+        hasher.update(force_order.size());
+        for (int position: force_order) {
+            hasher.update(static_cast<std::uint64_t>(position));
+        }
+
+        hasher.update(missing_argument_positions.size());
+        for (int position: missing_argument_positions) {
+            hasher.update(static_cast<std::uint64_t>(position));
+        }
+
+        hasher.update(static_cast<std::uint64_t>(return_value_type) << 3 |
+                      jumped << 2 | S3_method << 1 | S4_method);
+
+        return hasher.digest().low;
+    }
+
+    bool try_to_merge(const pos_seq_t& force_order,
+                      const pos_seq_t& missing_argument_positions,
+                      sexptype_t return_value_type,
+                      bool jumped,
+                      bool S3_method,
+                      bool S4_method,
+                      bool dynamic_call,
+                      int weight) {
+        if (is_mergeable_(force_order,
+                          missing_argument_positions,
+                          return_value_type,
+                          jumped,
+                          S3_method,
+                          S4_method)) {
+            call_count_ += weight;
+            if (dynamic_call) {
+                dynamic_call_count_ += weight;
             }
             return true;
         }
         return false;
     }
 
+    /* merges the counts of a summary of the same function from another
+       trace. */
+    bool try_to_merge(const CallSummary& other) {
+        if (is_mergeable_(other.get_force_order(),
+                          other.get_missing_argument_positions(),
+                          other.get_return_value_type(),
+                          other.is_jumped(),
+                          other.is_S3_method(),
+                          other.is_S4_method())) {
+            call_count_ += other.get_call_count();
+            dynamic_call_count_ += other.get_dynamic_call_count();
+            return true;
+        }
+        return false;
+    }
+
   private:
     pos_seq_t force_order_;
     pos_seq_t missing_argument_positions_;
@@ -68,15 +158,21 @@ class CallSummary {
     bool S4_method_;
     int call_count_;
     int dynamic_call_count_;
+    int checkpointed_call_count_;
+    int checkpointed_dynamic_call_count_;
 
-    bool is_mergeable_(const Call* const call) const {
-        return (get_force_order() == call->get_force_order() &&
+    bool is_mergeable_(const pos_seq_t& force_order,
+                       const pos_seq_t& missing_argument_positions,
+                       sexptype_t return_value_type,
+                       bool jumped,
+                       bool S3_method,
+                       bool S4_method) const {
+        return (get_force_order() == force_order &&
                 get_missing_argument_positions() ==
-                    call->get_missing_argument_positions() &&
-                is_jumped() == call->is_jumped() &&
-                get_return_value_type() == call->get_return_value_type() &&
-                is_S3_method() == call->is_S3_method() &&
-                is_S4_method() == call->is_S4_method());
+                    missing_argument_positions &&
+                is_jumped() == jumped &&
+                get_return_value_type() == return_value_type &&
+                is_S3_method() == S3_method && is_S4_method() == S4_method);
     }
 };
 
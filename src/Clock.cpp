@@ -0,0 +1,53 @@
+#include "Clock.h"
+
+#include <thread>
+
+#ifdef DYNAMISMTRACER_HAS_TSC
+#    include <cpuid.h>
+#endif
+
+/* how long the TSC is measured against the steady clock. */
+static const std::chrono::milliseconds TSC_CALIBRATION_DURATION(20);
+
+Clock::Clock(ClockType type)
+    : type_(type), tsc_frequency_(0), nanoseconds_per_tick_(1) {
+    if (type_ == ClockType::Tsc && !has_invariant_tsc_()) {
+        dyntrace_log_warning(
+            "invariant TSC not available, using high resolution clock");
+        type_ = ClockType::HighResolution;
+    }
+}
+
+bool Clock::has_invariant_tsc_() {
+#ifdef DYNAMISMTRACER_HAS_TSC
+    unsigned int eax, ebx, ecx, edx;
+
+    /* bit 8 of edx of the advanced power management leaf reports an
+     invariant TSC. */
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return (edx & (1U << 8)) != 0;
+    }
+#endif
+    return false;
+}
+
+void Clock::calibrate() {
+    if (type_ != ClockType::Tsc) {
+        return;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::uint64_t start_ticks = now();
+
+    std::this_thread::sleep_for(TSC_CALIBRATION_DURATION);
+
+    auto end_time = std::chrono::steady_clock::now();
+    std::uint64_t end_ticks = now();
+
+    double nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             end_time - start_time)
+                             .count();
+
+    nanoseconds_per_tick_ = nanoseconds / (end_ticks - start_ticks);
+    tsc_frequency_ = 1e9 / nanoseconds_per_tick_;
+}
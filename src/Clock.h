@@ -0,0 +1,123 @@
+#ifndef DYNAMISMTRACER_CLOCK_H
+#define DYNAMISMTRACER_CLOCK_H
+
+#include "stdlibs.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define DYNAMISMTRACER_HAS_TSC 1
+#endif
+
+/* The clocks that can be used to measure execution time. The execution
+ timer reads the clock on the entry and exit of every probe, so the cheaper
+ clocks trade precision for a lower tracing overhead. */
+enum class ClockType {
+    HighResolution = 0,
+    Tsc,
+    MonotonicCoarse,
+    Off,
+    COUNT
+};
+
+inline std::string to_string(const ClockType clock_type) {
+    switch (clock_type) {
+    case ClockType::HighResolution:
+        return "high_resolution";
+    case ClockType::Tsc:
+        return "tsc";
+    case ClockType::MonotonicCoarse:
+        return "monotonic_coarse";
+    case ClockType::Off:
+        return "off";
+    case ClockType::COUNT:
+        return "unknown_clock";
+    }
+
+    return "unknown_clock";
+}
+
+/* returns ClockType::COUNT if the name does not denote a clock. */
+inline ClockType string_to_clock_type(const std::string& name) {
+    for (int i = 0; i < static_cast<int>(ClockType::COUNT); ++i) {
+        if (to_string(static_cast<ClockType>(i)) == name) {
+            return static_cast<ClockType>(i);
+        }
+    }
+    return ClockType::COUNT;
+}
+
+/* Reads the selected clock in ticks and converts tick differences to
+ nanoseconds. All clocks except the TSC tick in nanoseconds. The TSC is only
+ used if it is invariant, i.e., it ticks at a constant rate regardless of
+ frequency scaling and sleep states. Its rate is measured once by calibrate.
+ */
+class Clock {
+  public:
+    explicit Clock(ClockType type);
+
+    ClockType get_type() const {
+        return type_;
+    }
+
+    bool is_off() const {
+        return type_ == ClockType::Off;
+    }
+
+    /* ticks per second of the TSC, 0 for the other clocks. */
+    double get_tsc_frequency() const {
+        return tsc_frequency_;
+    }
+
+    /* measures the rate of the TSC against the steady clock. this blocks
+     for a few milliseconds and should only be called before tracing. */
+    void calibrate();
+
+    std::uint64_t now() const {
+        switch (type_) {
+#ifdef DYNAMISMTRACER_HAS_TSC
+        case ClockType::Tsc:
+            return __rdtsc();
+#endif
+        case ClockType::MonotonicCoarse:
+            return read_monotonic_coarse_();
+        case ClockType::Off:
+            return 0;
+        default:
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::high_resolution_clock::now()
+                           .time_since_epoch())
+                .count();
+        }
+    }
+
+    std::uint64_t to_nanoseconds(std::uint64_t ticks) const {
+        if (type_ == ClockType::Tsc) {
+            return static_cast<std::uint64_t>(ticks * nanoseconds_per_tick_);
+        }
+        return ticks;
+    }
+
+  private:
+    static std::uint64_t read_monotonic_coarse_() {
+        struct timespec time;
+#ifdef CLOCK_MONOTONIC_COARSE
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+#else
+        clock_gettime(CLOCK_MONOTONIC, &time);
+#endif
+        return static_cast<std::uint64_t>(time.tv_sec) * 1000000000ULL +
+               time.tv_nsec;
+    }
+
+    static bool has_invariant_tsc_();
+
+    ClockType type_;
+    double tsc_frequency_;
+    double nanoseconds_per_tick_;
+};
+
+#endif /* DYNAMISMTRACER_CLOCK_H */
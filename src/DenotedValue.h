@@ -296,7 +296,6 @@ class DenotedValue {
 
     void set_self_scope_mutation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_self_scope_mutation_count_;
         } else {
@@ -327,7 +326,6 @@ class DenotedValue {
 
     void set_lexical_scope_mutation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_lexical_scope_mutation_count_;
         } else {
@@ -358,7 +356,6 @@ class DenotedValue {
 
     void set_non_lexical_scope_mutation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_non_lexical_scope_mutation_count_;
         } else {
@@ -389,7 +386,6 @@ class DenotedValue {
 
     void set_self_scope_observation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_self_scope_observation_count_;
         } else {
@@ -420,7 +416,6 @@ class DenotedValue {
 
     void set_lexical_scope_observation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_lexical_scope_observation_count_;
         } else {
@@ -451,7 +446,6 @@ class DenotedValue {
 
     void set_non_lexical_scope_observation(bool direct) {
         check_and_set_escape_();
-        cache_expression_();
         if (direct) {
             ++direct_non_lexical_scope_observation_count_;
         } else {
@@ -555,8 +549,34 @@ class DenotedValue {
         return lifecycle_;
     }
 
-    const std::string& get_serialized_expression() const {
-        return serialized_expression_;
+    /* the expression of a promise is written to the expressions table once
+       and referred to by its id. */
+    bool has_expression_id() const {
+        return expression_id_ != UNASSIGNED_EXPRESSION_ID;
+    }
+
+    int get_expression_id() const {
+        return expression_id_;
+    }
+
+    void set_expression_id(int expression_id) {
+        expression_id_ = expression_id;
+    }
+
+    bool has_side_effects() const {
+        return get_self_scope_mutation_count(true) +
+                   get_self_scope_mutation_count(false) +
+                   get_lexical_scope_mutation_count(true) +
+                   get_lexical_scope_mutation_count(false) +
+                   get_non_lexical_scope_mutation_count(true) +
+                   get_non_lexical_scope_mutation_count(false) +
+                   get_self_scope_observation_count(true) +
+                   get_self_scope_observation_count(false) +
+                   get_lexical_scope_observation_count(true) +
+                   get_lexical_scope_observation_count(false) +
+                   get_non_lexical_scope_observation_count(true) +
+                   get_non_lexical_scope_observation_count(false) >
+               0;
     }
 
   private:
@@ -591,8 +611,7 @@ class DenotedValue {
               UNASSIGNED_ACTUAL_ARGUMENT_POSITION)
         , previous_call_return_value_type_(UNASSIGNEDSXP)
         , previous_default_argument_(false)
-        , expression_cached_(false)
-        , serialized_expression_("")
+        , expression_id_(UNASSIGNED_EXPRESSION_ID)
         , before_escape_force_count_(0)
         , force_count_(0)
         , before_escape_value_lookup_count_(0)
@@ -730,13 +749,6 @@ class DenotedValue {
         }
     }
 
-    void cache_expression_() {
-        if (!expression_cached_) {
-            serialized_expression_ = serialize_r_expression(get_expression());
-            expression_cached_ = true;
-        }
-    }
-
     denoted_value_id_t id_;
     sexptype_t type_;
     sexptype_t expression_type_;
@@ -765,8 +777,7 @@ class DenotedValue {
     int previous_actual_argument_position_;
     sexptype_t previous_call_return_value_type_;
     bool previous_default_argument_;
-    bool expression_cached_;
-    std::string serialized_expression_;
+    int expression_id_;
     int before_escape_force_count_;
     int force_count_;
     int before_escape_value_lookup_count_;
@@ -0,0 +1,87 @@
+#ifndef DYNAMISMTRACER_DICTIONARY_H
+#define DYNAMISMTRACER_DICTIONARY_H
+
+#include "sexptypes.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+/* A value of a categorical column. In binary mode the code is written in
+   place of the value and the values are written once per table to a
+   dictionary table. In text mode the value is written. The value is owned
+   by the dictionary, so rows carry a pointer instead of a copy. */
+struct Category {
+    int code;
+    const std::string* value;
+};
+
+/* Assigns codes to the values of the categorical columns of a table in
+   order of first use. */
+class Dictionary {
+  public:
+    Category encode(const std::string& value) {
+        auto iter = codes_.find(value);
+
+        if (iter != codes_.end()) {
+            return {iter->second, &values_[iter->second]};
+        }
+
+        const int code = static_cast<int>(values_.size());
+        /* a deque does not move its elements when it grows, so the rows
+           queued for the writer thread can keep pointing to them. */
+        values_.push_back(value);
+        codes_.insert({value, code});
+
+        return {code, &values_.back()};
+    }
+
+    /* the name of a type is only built the first time the type is seen. */
+    Category encode_sexptype(sexptype_t type) {
+        auto iter = sexptype_categories_.find(type);
+
+        if (iter != sexptype_categories_.end()) {
+            return iter->second;
+        }
+
+        const Category category = encode(sexptype_to_string(type));
+        sexptype_categories_.insert({type, category});
+
+        return category;
+    }
+
+    std::size_t get_size() const {
+        return values_.size();
+    }
+
+    const std::string& get_value(int code) const {
+        return values_[code];
+    }
+
+  private:
+    std::deque<std::string> values_;
+    std::unordered_map<std::string, int> codes_;
+    std::unordered_map<sexptype_t, Category> sexptype_categories_;
+};
+
+/* the column values handed to a table. categories are replaced by their
+   codes or by their values, everything else is passed through. */
+inline int to_column_code(const Category& category) {
+    return category.code;
+}
+
+template <typename T>
+const T& to_column_code(const T& value) {
+    return value;
+}
+
+inline const std::string& to_column_value(const Category& category) {
+    return *category.value;
+}
+
+template <typename T>
+const T& to_column_value(const T& value) {
+    return value;
+}
+
+#endif /* DYNAMISMTRACER_DICTIONARY_H */
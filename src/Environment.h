@@ -1,7 +1,7 @@
 #ifndef DYNAMISMTRACER_ENVIRONMENT_H
 #define DYNAMISMTRACER_ENVIRONMENT_H
 
-#include <unordered_map>
+#include "SexpMap.h"
 
 typedef int env_id_t;
 
@@ -16,21 +16,30 @@ class Environment {
         return id_;
     }
 
-    Variable& lookup(const std::string& symbol) {
+    Variable& lookup(const SEXP symbol) {
         auto iter = variable_mapping_.find(symbol);
         if (iter == variable_mapping_.end()) {
             dyntrace_log_error("Unable to find variable %s in environment.",
-                               symbol.c_str());
+                               CHAR(PRINTNAME(symbol)));
         }
         return iter->second;
     }
 
-    bool exists(const std::string& symbol) {
+    std::size_t get_variable_count() const {
+        return variable_mapping_.size();
+    }
+
+    /* the bytes held by this environment and its variables. */
+    std::size_t get_memory_usage() const {
+        return sizeof(Environment) + variable_mapping_.get_memory_usage();
+    }
+
+    bool exists(const SEXP symbol) {
         auto iter = variable_mapping_.find(symbol);
         return (iter != variable_mapping_.end());
     }
 
-    Variable& define(const std::string& symbol,
+    Variable& define(const SEXP symbol,
                      const var_id_t var_id,
                      const timestamp_t timestamp) {
         auto iter = variable_mapping_.insert(
@@ -38,7 +47,7 @@ class Environment {
         return iter.first->second;
     }
 
-    Variable remove(const std::string& symbol) {
+    Variable remove(const SEXP symbol) {
         const auto iter = variable_mapping_.find(symbol);
         if (iter == variable_mapping_.end()) {
             dyntrace_log_error("ERROR: unable to find variable for removal");
@@ -52,7 +61,8 @@ class Environment {
     const SEXP rho_;
     const env_id_t id_;
 
-    std::unordered_map<std::string, Variable> variable_mapping_;
+    /* symbols are interned by R, so the symbol itself is the key. */
+    SexpMap<Variable> variable_mapping_;
 };
 
 #endif /* DYNAMISMTRACER_ENVIRONMENT_H */
@@ -1,6 +1,8 @@
 #ifndef DYNAMISMTRACER_EVENT_H
 #define DYNAMISMTRACER_EVENT_H
 
+#include "stdlibs.h"
+
 #include <string>
 
 enum class Event {
@@ -0,0 +1,145 @@
+#include "EventLog.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* the log is mapped in chunks of at least this size. */
+static const std::size_t EVENT_LOG_INITIAL_CAPACITY = 64 * 1024 * 1024;
+
+EventLogWriter::EventLogWriter(const std::string& filepath)
+    : filepath_(filepath)
+    , fd_(-1)
+    , data_(nullptr)
+    , size_(0)
+    , capacity_(0) {
+    fd_ = open(filepath_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd_ == -1) {
+        dyntrace_log_error("unable to open event log '%s'", filepath_.c_str());
+    }
+
+    grow_(EVENT_LOG_INITIAL_CAPACITY);
+
+    for (std::size_t i = 0; i < sizeof(EVENT_LOG_MAGIC); ++i) {
+        write_byte(EVENT_LOG_MAGIC[i]);
+    }
+    write_varint(EVENT_LOG_VERSION);
+}
+
+void EventLogWriter::grow_(std::size_t minimum_capacity) {
+    std::size_t capacity = std::max(capacity_, EVENT_LOG_INITIAL_CAPACITY);
+
+    while (capacity < minimum_capacity) {
+        capacity *= 2;
+    }
+
+    if (data_ != nullptr) {
+        munmap(data_, capacity_);
+        data_ = nullptr;
+    }
+
+    if (ftruncate(fd_, capacity) == -1) {
+        dyntrace_log_error("unable to grow event log '%s'", filepath_.c_str());
+    }
+
+    void* data =
+        mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+    if (data == MAP_FAILED) {
+        dyntrace_log_error("unable to map event log '%s'", filepath_.c_str());
+    }
+
+    data_ = static_cast<std::uint8_t*>(data);
+    capacity_ = capacity;
+}
+
+void EventLogWriter::close() {
+    if (fd_ == -1) {
+        return;
+    }
+
+    munmap(data_, capacity_);
+    data_ = nullptr;
+    capacity_ = 0;
+
+    /* drop the unused tail of the last chunk. */
+    if (ftruncate(fd_, size_) == -1) {
+        dyntrace_log_warning("unable to truncate event log '%s'",
+                             filepath_.c_str());
+    }
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+EventLogReader::EventLogReader(const std::string& filepath)
+    : filepath_(filepath), fd_(-1), data_(nullptr), size_(0), position_(0) {
+    /* the destructor does not run if the constructor throws. */
+    try {
+        open_();
+    } catch (...) {
+        release_();
+        throw;
+    }
+}
+
+EventLogReader::~EventLogReader() {
+    release_();
+}
+
+void EventLogReader::open_() {
+    fd_ = open(filepath_.c_str(), O_RDONLY);
+
+    if (fd_ == -1) {
+        throw EventLogError("unable to open event log '" + filepath_ + "'");
+    }
+
+    struct stat status;
+
+    if (fstat(fd_, &status) == -1) {
+        throw EventLogError("unable to stat event log '" + filepath_ + "'");
+    }
+
+    size_ = status.st_size;
+
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+
+        if (data == MAP_FAILED) {
+            throw EventLogError("unable to map event log '" + filepath_ +
+                                "'");
+        }
+
+        data_ = static_cast<const std::uint8_t*>(data);
+        madvise(const_cast<std::uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+    }
+
+    for (std::size_t i = 0; i < sizeof(EVENT_LOG_MAGIC); ++i) {
+        if (read_byte() != static_cast<std::uint8_t>(EVENT_LOG_MAGIC[i])) {
+            throw EventLogError("'" + filepath_ + "' is not an event log");
+        }
+    }
+
+    std::uint64_t version = read_varint();
+
+    if (version != EVENT_LOG_VERSION) {
+        throw EventLogError("event log '" + filepath_ +
+                            "' has unsupported version " +
+                            std::to_string(version));
+    }
+}
+
+void EventLogReader::release_() {
+    if (data_ != nullptr) {
+        munmap(const_cast<std::uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
@@ -0,0 +1,177 @@
+#ifndef DYNAMISMTRACER_EVENT_LOG_H
+#define DYNAMISMTRACER_EVENT_LOG_H
+
+#include "Event.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/* The record mode of the tracer appends one record per probe event to an
+ event log and defers all analysis to a replay of the log. A record starts
+ with a tag byte. Probe records are tagged with their Event, followed by the
+ time since the previous record in nanoseconds and the probe payload. The
+ records below describe the objects that probe records refer to by id. Ids
+ are small integers handed out in order of first use, and all integers are
+ written as LEB128 varints, so most records take a handful of bytes. */
+enum class EventLogRecord : std::uint8_t {
+    /* name id, name. */
+    Name = 0xF0,
+    /* function ref, function id, namespace, type, formal parameter count,
+     byte compiled, primitive offset, primitive force order, definition.
+     the definition is only logged the first time a function id is seen and
+     is empty afterwards. */
+    Function,
+    /* counts of the events that are too frequent to be logged one by one.
+     eval count, count of unlogged gc unmarks. */
+    Counts
+};
+
+const char EVENT_LOG_MAGIC[] = "DYNLOG";
+const std::uint64_t EVENT_LOG_VERSION = 3;
+const std::string EVENT_LOG_FILENAME = "events.log";
+
+/* Appends records to a memory mapped file. The mapping grows by doubling and
+ the file is truncated to the logged size when the writer is closed. */
+class EventLogWriter {
+  public:
+    explicit EventLogWriter(const std::string& filepath);
+
+    EventLogWriter(const EventLogWriter& other) = delete;
+
+    EventLogWriter& operator=(const EventLogWriter& other) = delete;
+
+    ~EventLogWriter() {
+        close();
+    }
+
+    void write_byte(std::uint8_t byte) {
+        reserve_(1);
+        data_[size_++] = byte;
+    }
+
+    void write_varint(std::uint64_t value) {
+        /* a 64 bit varint takes at most 10 bytes. */
+        reserve_(10);
+        while (value >= 0x80) {
+            data_[size_++] = static_cast<std::uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        data_[size_++] = static_cast<std::uint8_t>(value);
+    }
+
+    /* small negative values are zigzag encoded to keep them short. */
+    void write_signed_varint(std::int64_t value) {
+        write_varint((static_cast<std::uint64_t>(value) << 1) ^
+                     static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void write_string(const std::string& value) {
+        write_varint(value.size());
+        reserve_(value.size());
+        std::memcpy(data_ + size_, value.data(), value.size());
+        size_ += value.size();
+    }
+
+    std::size_t get_size() const {
+        return size_;
+    }
+
+    void close();
+
+  private:
+    void reserve_(std::size_t size) {
+        if (size_ + size > capacity_) {
+            grow_(size_ + size);
+        }
+    }
+
+    void grow_(std::size_t minimum_capacity);
+
+    std::string filepath_;
+    int fd_;
+    std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t capacity_;
+};
+
+/* A log that cannot be read or replayed. Logs may be replayed on threads
+ other than the R thread, where the R error routines cannot be called, so
+ reading and replaying a log report errors with this exception. The caller
+ reports them to R from the R thread. */
+class EventLogError: public std::runtime_error {
+  public:
+    explicit EventLogError(const std::string& message)
+        : std::runtime_error(message) {
+    }
+};
+
+/* Reads the records of an event log from a read only mapping of the file. */
+class EventLogReader {
+  public:
+    explicit EventLogReader(const std::string& filepath);
+
+    EventLogReader(const EventLogReader& other) = delete;
+
+    EventLogReader& operator=(const EventLogReader& other) = delete;
+
+    ~EventLogReader();
+
+    bool is_at_end() const {
+        return position_ == size_;
+    }
+
+    std::uint8_t read_byte() {
+        check_available_(1);
+        return data_[position_++];
+    }
+
+    std::uint64_t read_varint() {
+        std::uint64_t value = 0;
+        int shift = 0;
+        std::uint8_t byte;
+
+        do {
+            byte = read_byte();
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        return value;
+    }
+
+    std::int64_t read_signed_varint() {
+        std::uint64_t value = read_varint();
+        return static_cast<std::int64_t>(value >> 1) ^
+               -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::string read_string() {
+        std::size_t size = read_varint();
+        check_available_(size);
+        std::string value(reinterpret_cast<const char*>(data_ + position_),
+                          size);
+        position_ += size;
+        return value;
+    }
+
+  private:
+    void check_available_(std::size_t size) const {
+        if (size_ - position_ < size) {
+            throw EventLogError("event log '" + filepath_ + "' is truncated");
+        }
+    }
+
+    void open_();
+
+    void release_();
+
+    std::string filepath_;
+    int fd_;
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t position_;
+};
+
+#endif /* DYNAMISMTRACER_EVENT_LOG_H */
@@ -3,5 +3,63 @@
 #include "Function.h"
 
 ExecutionContext::ExecutionContext(Call* call)
-    : type_(call->get_function()->get_type()), call_(call), execution_time_(0) {
+    : type_(call->get_function()->get_type())
+    , call_(call)
+    , function_(call->get_function())
+    , function_name_(nullptr)
+    , environment_(nullptr)
+    , dispatch_(DYNTRACE_DISPATCH_NONE)
+    , creation_scope_function_(nullptr)
+    , closure_index_(-1)
+    , promise_index_(-1)
+    , execution_time_(0) {
+}
+
+ExecutionContext::ExecutionContext(Function* function,
+                                   const char* function_name,
+                                   const SEXP environment,
+                                   const dyntrace_dispatch_t dispatch)
+    : type_(function->get_type())
+    , call_(nullptr)
+    , function_(function)
+    , function_name_(function_name)
+    , environment_(environment)
+    , dispatch_(dispatch)
+    , creation_scope_function_(nullptr)
+    , closure_index_(-1)
+    , promise_index_(-1)
+    , execution_time_(0) {
+}
+
+const char* ExecutionContext::get_function_name() const {
+    if (has_call()) {
+        return call_->get_function_name();
+    }
+    return function_name_;
+}
+
+SEXP ExecutionContext::get_environment() const {
+    if (has_call()) {
+        return call_->get_environment();
+    }
+    return environment_;
+}
+
+void ExecutionContext::annotate(const ExecutionContext* parent, int index) {
+    if (parent != nullptr) {
+        creation_scope_function_ = parent->creation_scope_function_;
+        closure_index_ = parent->closure_index_;
+        promise_index_ = parent->promise_index_;
+    }
+
+    if (is_closure()) {
+        closure_index_ = index;
+    } else if (is_promise()) {
+        promise_index_ = index;
+    }
+
+    /* '{' function as promise creation source is not very insightful. */
+    if (is_call() && !function_->is_curly_bracket()) {
+        creation_scope_function_ = function_;
+    }
 }
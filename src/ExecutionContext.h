@@ -8,20 +8,48 @@
 /* forward declarations to prevent cyclic dependencies */
 class DenotedValue;
 class Call;
+class Function;
 
 class ExecutionContext {
   public:
     explicit ExecutionContext(DenotedValue* promise_state)
-        : type_(PROMSXP), promise_state_(promise_state), execution_time_(0) {
+        : type_(PROMSXP)
+        , promise_state_(promise_state)
+        , function_(nullptr)
+        , function_name_(nullptr)
+        , environment_(nullptr)
+        , dispatch_(DYNTRACE_DISPATCH_NONE)
+        , creation_scope_function_(nullptr)
+        , closure_index_(-1)
+        , promise_index_(-1)
+        , execution_time_(0) {
     }
 
     explicit ExecutionContext(const RCNTXT* r_context)
-        : type_(CONTEXTSXP), r_context_(r_context), execution_time_(0) {
+        : type_(CONTEXTSXP)
+        , r_context_(r_context)
+        , function_(nullptr)
+        , function_name_(nullptr)
+        , environment_(nullptr)
+        , dispatch_(DYNTRACE_DISPATCH_NONE)
+        , creation_scope_function_(nullptr)
+        , closure_index_(-1)
+        , promise_index_(-1)
+        , execution_time_(0) {
     }
 
     /* defined in cpp file to get around cyclic dependency issues. */
     explicit ExecutionContext(Call* call);
 
+    /* a compact call frame. It records the function being called without
+       materializing a Call object. This is used for the bulk of builtin and
+       special calls which are summarized but not analyzed any further, and
+       for closure calls that are not sampled. */
+    explicit ExecutionContext(Function* function,
+                              const char* function_name,
+                              const SEXP environment,
+                              const dyntrace_dispatch_t dispatch);
+
     sexptype_t get_type() const {
         return type_;
     }
@@ -46,6 +74,12 @@ class ExecutionContext {
         return is_builtin() || is_special() || is_closure();
     }
 
+    /* true for call frames that carry a Call object, false for compact call
+       frames and non call frames. */
+    bool has_call() const {
+        return is_call() && call_ != nullptr;
+    }
+
     bool is_r_context() const {
         return (type_ == CONTEXTSXP);
     }
@@ -74,6 +108,48 @@ class ExecutionContext {
         return r_context_;
     }
 
+    Function* get_function() const {
+        return function_;
+    }
+
+    /* defined in cpp file to get around cyclic dependency issues. */
+    const char* get_function_name() const;
+
+    /* defined in cpp file to get around cyclic dependency issues. */
+    SEXP get_environment() const;
+
+    bool is_S3_method() const {
+        return dispatch_ == DYNTRACE_DISPATCH_S3;
+    }
+
+    bool is_S4_method() const {
+        return dispatch_ == DYNTRACE_DISPATCH_S4;
+    }
+
+    /* records the scopes enclosing this frame when it is pushed at the
+       given index on top of parent, which is null for the bottom frame.
+       defined in cpp file to get around cyclic dependency issues. */
+    void annotate(const ExecutionContext* parent, int index);
+
+    /* the function of the nearest call frame, this one included, that is
+       not a '{' call. null if there is no such frame. */
+    const Function* get_creation_scope_function() const {
+        return creation_scope_function_;
+    }
+
+    /* the stack index of the nearest closure frame, this one included. -1 if
+       there is no such frame. */
+    int get_closure_index() const {
+        return closure_index_;
+    }
+
+    /* the stack index of the nearest promise frame, this one included. -1 if
+       there is no such frame. following these indices from the top visits
+       the promise frames without visiting the other frames. */
+    int get_promise_index() const {
+        return promise_index_;
+    }
+
     void increment_execution_time(const std::uint64_t increment) {
         execution_time_ += increment;
     }
@@ -89,6 +165,13 @@ class ExecutionContext {
         Call* call_;
         const RCNTXT* r_context_;
     };
+    Function* function_;
+    const char* function_name_;
+    SEXP environment_;
+    dyntrace_dispatch_t dispatch_;
+    const Function* creation_scope_function_;
+    int closure_index_;
+    int promise_index_;
     std::uint64_t execution_time_;
 };
 
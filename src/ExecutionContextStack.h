@@ -59,12 +59,19 @@ class ExecutionContextStack {
 
     template <typename T>
     void push(T* context) {
-        stack_.push_back(ExecutionContext(context));
+        push_(ExecutionContext(context));
+    }
+
+    void push(Function* function,
+              const char* function_name,
+              const SEXP environment,
+              const dyntrace_dispatch_t dispatch) {
+        push_(ExecutionContext(function, function_name, environment, dispatch));
     }
 
     ExecutionContext pop() {
         ExecutionContext context{peek(1)};
-        stack_.pop_back();
+        pop_();
         return context;
     }
 
@@ -76,6 +83,11 @@ class ExecutionContextStack {
         return stack_.at(stack_.size() - n);
     }
 
+    /* the frame at the given index from the bottom of the stack. */
+    const ExecutionContext& get(std::size_t index) const {
+        return stack_[index];
+    }
+
     execution_contexts_t unwind(const ExecutionContext& context) {
         execution_contexts_t unwound_contexts;
 
@@ -86,13 +98,48 @@ class ExecutionContextStack {
                 (temp_context.get_r_context() == context.get_r_context())) {
                 return unwound_contexts;
             }
-            stack_.pop_back();
             unwound_contexts.push_back(temp_context);
+            pop_();
         }
         dyntrace_log_error("cannot find matching context while unwinding\n");
     }
 
+    /* the scope annotation of the top frame summarizes the whole stack, so
+       the creation scope query does not walk the stack. */
+    const Function* get_creation_scope_function() const {
+        return is_empty() ? nullptr : peek(1).get_creation_scope_function();
+    }
+
+    /* is a closure running in rho above the frame at the given index. only
+       the closure frames are visited, by following their indices. */
+    bool has_closure_above(const SEXP rho, int index) const {
+        int closure_index = is_empty() ? -1 : peek(1).get_closure_index();
+
+        while (closure_index > index) {
+            const ExecutionContext& context = stack_[closure_index];
+
+            if (context.get_environment() == rho) {
+                return true;
+            }
+
+            closure_index = closure_index == 0
+                                ? -1
+                                : stack_[closure_index - 1].get_closure_index();
+        }
+
+        return false;
+    }
+
   private:
+    void push_(ExecutionContext context) {
+        context.annotate(is_empty() ? nullptr : &stack_.back(), size());
+        stack_.push_back(context);
+    }
+
+    void pop_() {
+        stack_.pop_back();
+    }
+
     execution_contexts_t stack_;
 };
 
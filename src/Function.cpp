@@ -1,5 +1,7 @@
 #include "Function.h"
 
+#include "hash.h"
+
 std::string Function::find_namespace(const SEXP op) {
     if (TYPEOF(op) == SPECIALSXP || TYPEOF(op) == BUILTINSXP) {
         return "base";
@@ -66,21 +68,24 @@ std::string Function::find_namespace(const SEXP op) {
     return name;
 }
 
-std::tuple<std::string, std::string, function_id_t>
-Function::compute_definition_and_id(const SEXP op) {
-    std::string definition;
-    std::string package_name;
-    function_id_t id;
-
-    if (type_of_sexp(op) == CLOSXP) {
-        definition = serialize_r_expression(op);
-        package_name = find_namespace(op);
-        id = compute_hash((package_name + definition).c_str());
-    } else {
-        definition = "function body not extracted for non closures";
-        package_name = "base";
-        id = dyntrace_get_c_function_name(op);
+std::pair<std::string, function_id_t>
+Function::compute_namespace_and_id(const SEXP op) {
+    if (type_of_sexp(op) != CLOSXP) {
+        return {"base", dyntrace_get_c_function_name(op)};
     }
 
-    return make_tuple(package_name, definition, id);
+    std::string package_name = find_namespace(op);
+
+    Hasher hasher;
+    hasher.update(package_name.c_str());
+    hash_sexp(hasher, op);
+
+    return {package_name, hash_to_string(hasher.digest())};
+}
+
+std::string Function::compute_definition(const SEXP op) {
+    if (type_of_sexp(op) != CLOSXP) {
+        return "function body not extracted for non closures";
+    }
+    return serialize_r_expression(op);
 }
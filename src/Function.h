@@ -3,11 +3,15 @@
 
 #include "Call.h"
 #include "CallSummary.h"
+#include "Dictionary.h"
 #include "Rinternals.h"
 #include "sexptypes.h"
 #include "utilities.h"
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <unordered_map>
 
 class Function {
   public:
@@ -17,6 +21,9 @@ class Function {
                       const function_id_t& id)
         : formal_parameter_count_(0)
         , wrapper_(true)
+        , reference_count_(0)
+        , sampling_countdown_(-1)
+        , name_category_{-1, nullptr}
         , namespace_(package_name)
         , definition_(definition)
         , id_(id) {
@@ -33,9 +40,34 @@ class Function {
             formal_parameter_count_ = dyntrace_get_c_function_arity(op);
             primitive_offset_ = dyntrace_get_primitive_offset(op);
             byte_compiled_ = false;
+            primitive_force_order_ = {
+                dyntrace_get_c_function_argument_evaluation(op)};
         }
     }
 
+    /* a function restored from the attributes logged in record mode. */
+    explicit Function(sexptype_t type,
+                      std::size_t formal_parameter_count,
+                      bool byte_compiled,
+                      int primitive_offset,
+                      const pos_seq_t& primitive_force_order,
+                      const std::string& package_name,
+                      const std::string& definition,
+                      const function_id_t& id)
+        : type_(type)
+        , formal_parameter_count_(formal_parameter_count)
+        , wrapper_(true)
+        , reference_count_(0)
+        , sampling_countdown_(-1)
+        , name_category_{-1, nullptr}
+        , namespace_(package_name)
+        , definition_(definition)
+        , id_(id)
+        , primitive_offset_(primitive_offset)
+        , byte_compiled_(byte_compiled)
+        , primitive_force_order_(primitive_force_order) {
+    }
+
     bool is_byte_compiled() const {
         return byte_compiled_;
     }
@@ -109,6 +141,15 @@ class Function {
         return (get_primitive_offset() == PRIMITIVE_DOT_CALL_GRAPHICS_OFFSET_);
     }
 
+    /* primitives that hand over the call to internal or native code. calls to
+       these are trivially wrappers. */
+    bool is_native_interface() const {
+        return is_dot_internal() || is_dot_primitive() || is_dot_c() ||
+               is_dot_fortran() || is_dot_external() || is_dot_external2() ||
+               is_dot_call() || is_dot_external_graphics() ||
+               is_dot_call_graphics();
+    }
+
     bool is_left_assign() const {
         return (get_primitive_offset() == PRIMITIVE_LEFT_ASSIGN_OFFSET_);
     }
@@ -129,6 +170,12 @@ class Function {
         return definition_;
     }
 
+    /* the definition is written to its table when the function is first
+       cached and is not needed afterwards. */
+    void drop_definition() {
+        std::string().swap(definition_);
+    }
+
     const std::string& get_namespace() const {
         return namespace_;
     }
@@ -141,41 +188,117 @@ class Function {
         return call_summaries_[summary_index];
     }
 
-    const std::vector<std::string>& get_names() const {
+    CallSummary& get_call_summary(std::size_t summary_index) {
+        return call_summaries_[summary_index];
+    }
+
+    /* how a primitive evaluates its arguments. empty for closures. */
+    const pos_seq_t& get_primitive_force_order() const {
+        return primitive_force_order_;
+    }
+
+    /* the names are interned by R, so they are compared by address. */
+    const std::vector<const char*>& get_names() const {
         return names_;
     }
 
+    void add_name(const char* function_name) {
+        for (const char* name: names_) {
+            if (name == function_name) {
+                return;
+            }
+        }
+
+        names_.push_back(function_name);
+        name_category_.value = nullptr;
+    }
+
     bool is_wrapper() const {
         return wrapper_;
     }
 
-    void add_summary(Call* call) {
-        int i;
+    void add_reference() {
+        ++reference_count_;
+    }
+
+    int remove_reference() {
+        return --reference_count_;
+    }
 
+    /* the number of calls to skip before the next sampled call when calls
+       are sampled per function. negative until the first call. */
+    int& get_sampling_countdown() {
+        return sampling_countdown_;
+    }
+
+    /* a sampled call stands for weight calls of the function. */
+    void add_summary(Call* call, int weight) {
         wrapper_ = wrapper_ && call->is_wrapper();
 
-        for (i = 0; i < names_.size(); ++i) {
-            if (names_[i] == call->get_function_name()) {
-                break;
-            }
-        }
+        add_name(call->get_function_name());
 
-        if (i == names_.size()) {
-            names_.push_back(call->get_function_name());
-        }
+        add_summary_(call->get_force_order(),
+                     call->get_missing_argument_positions(),
+                     call->get_return_value_type(),
+                     call->is_jumped(),
+                     call->is_S3_method(),
+                     call->is_S4_method(),
+                     call->is_dynamic_call(),
+                     weight);
+    }
 
-        for (i = 0; i < call_summaries_.size(); ++i) {
-            if (call_summaries_[i].try_to_merge(call)) {
-                return;
+    /* summarize a primitive call that was traced without a Call object.
+       such calls have no tracked arguments and the force order is given by
+       the argument evaluation strategy of the primitive. */
+    void add_summary(const char* function_name,
+                     sexptype_t return_value_type,
+                     bool jumped,
+                     bool S3_method,
+                     bool S4_method) {
+        wrapper_ = wrapper_ && is_native_interface();
+
+        add_name(function_name);
+
+        add_summary_(primitive_force_order_,
+                     {},
+                     return_value_type,
+                     jumped,
+                     S3_method,
+                     S4_method,
+                     false,
+                     1);
+    }
+
+    /* merges the state of the same function from another trace. the names
+       of the other trace are interned separately, so they are compared by
+       content. */
+    void merge(const Function& other) {
+        wrapper_ = wrapper_ && other.is_wrapper();
+
+        for (const char* other_name: other.get_names()) {
+            bool found = false;
+
+            for (const char* name: names_) {
+                if (std::strcmp(name, other_name) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                names_.push_back(other_name);
+                name_category_.value = nullptr;
             }
         }
 
-        call_summaries_.push_back(CallSummary(call));
+        for (const CallSummary& other_summary: other.call_summaries_) {
+            merge_summary_(other_summary);
+        }
     }
 
     std::string get_name_string() const {
         const std::string& package = get_namespace();
-        const std::vector<std::string>& names = get_names();
+        const std::vector<const char*>& names = get_names();
 
         std::string all_names = "(";
 
@@ -192,23 +315,107 @@ class Function {
         return all_names;
     }
 
+    /* the name string is built and encoded again only after a name is
+       added, so the function must always be encoded into the same
+       dictionary. */
+    Category encode_name_string(Dictionary& dictionary) {
+        if (name_category_.value == nullptr) {
+            name_category_ = dictionary.encode(get_name_string());
+        }
+        return name_category_;
+    }
+
     static std::string find_namespace(const SEXP op);
 
-    static std::tuple<std::string, std::string, function_id_t>
-    compute_definition_and_id(const SEXP op);
+    /* the id of a closure is a structural hash of its namespace, formals
+       and body. it is cheap to compute and does not deparse the closure. */
+    static std::pair<std::string, function_id_t>
+    compute_namespace_and_id(const SEXP op);
+
+    static std::string compute_definition(const SEXP op);
 
   private:
+    void add_summary_(const pos_seq_t& force_order,
+                      const pos_seq_t& missing_argument_positions,
+                      sexptype_t return_value_type,
+                      bool jumped,
+                      bool S3_method,
+                      bool S4_method,
+                      bool dynamic_call,
+                      int weight) {
+        const std::uint64_t fingerprint =
+            CallSummary::compute_fingerprint(force_order,
+                                             missing_argument_positions,
+                                             return_value_type,
+                                             jumped,
+                                             S3_method,
+                                             S4_method);
+
+        auto range = call_summary_indices_.equal_range(fingerprint);
+
+        for (auto it = range.first; it != range.second; ++it) {
+            if (call_summaries_[it->second].try_to_merge(
+                    force_order,
+                    missing_argument_positions,
+                    return_value_type,
+                    jumped,
+                    S3_method,
+                    S4_method,
+                    dynamic_call,
+                    weight)) {
+                return;
+            }
+        }
+
+        call_summary_indices_.emplace(fingerprint, call_summaries_.size());
+        call_summaries_.push_back(CallSummary(force_order,
+                                              missing_argument_positions,
+                                              return_value_type,
+                                              jumped,
+                                              S3_method,
+                                              S4_method,
+                                              dynamic_call,
+                                              weight));
+    }
+
+    void merge_summary_(const CallSummary& other_summary) {
+        const std::uint64_t fingerprint = CallSummary::compute_fingerprint(
+            other_summary.get_force_order(),
+            other_summary.get_missing_argument_positions(),
+            other_summary.get_return_value_type(),
+            other_summary.is_jumped(),
+            other_summary.is_S3_method(),
+            other_summary.is_S4_method());
+
+        auto range = call_summary_indices_.equal_range(fingerprint);
+
+        for (auto it = range.first; it != range.second; ++it) {
+            if (call_summaries_[it->second].try_to_merge(other_summary)) {
+                return;
+            }
+        }
+
+        call_summary_indices_.emplace(fingerprint, call_summaries_.size());
+        call_summaries_.push_back(other_summary);
+    }
+
     sexptype_t type_;
     std::size_t formal_parameter_count_;
     bool wrapper_;
+    int reference_count_;
+    int sampling_countdown_;
+    Category name_category_;
     std::string namespace_;
     std::string definition_;
     function_id_t id_;
     int primitive_offset_;
     bool byte_compiled_;
+    pos_seq_t primitive_force_order_;
 
-    std::vector<std::string> names_;
+    std::vector<const char*> names_;
     std::vector<CallSummary> call_summaries_;
+    /* maps the fingerprint of a summary to its index in call_summaries_. */
+    std::unordered_multimap<std::uint64_t, std::size_t> call_summary_indices_;
 
 
     static const int PRIMITIVE_LEFT_ASSIGN_OFFSET_ = 8;
@@ -0,0 +1,92 @@
+#ifndef DYNAMISMTRACER_HISTOGRAM_H
+#define DYNAMISMTRACER_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/* A log-linear histogram of durations in the style of HdrHistogram. Every
+ power of 2 is split into SUB_BUCKET_COUNT_ linear sub-buckets, so a
+ recorded value is known to within 1/SUB_BUCKET_COUNT_ of itself. Recording
+ is a few arithmetic operations and an increment, and the histogram covers
+ the whole 64 bit range in a fixed amount of memory. The count, total and
+ maximum are kept exactly. */
+class Histogram {
+  public:
+    Histogram(): count_(0), total_(0), maximum_(0) {
+        buckets_.fill(0);
+    }
+
+    void record(std::uint64_t value) {
+        ++buckets_[to_index_(value)];
+        ++count_;
+        total_ += value;
+        maximum_ = std::max(maximum_, value);
+    }
+
+    std::uint64_t get_count() const {
+        return count_;
+    }
+
+    std::uint64_t get_total() const {
+        return total_;
+    }
+
+    std::uint64_t get_maximum() const {
+        return maximum_;
+    }
+
+    /* the largest value that falls in the same bucket as the value at the
+     given percentile. it never underestimates the percentile by more than
+     the precision of the histogram. */
+    std::uint64_t get_percentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+
+        std::uint64_t rank = static_cast<std::uint64_t>(
+            std::max(1.0, percentile / 100.0 * count_ + 0.5));
+        std::uint64_t seen = 0;
+
+        for (std::size_t index = 0; index < BUCKET_COUNT_; ++index) {
+            seen += buckets_[index];
+            if (seen >= rank) {
+                return std::min(to_highest_value_(index), maximum_);
+            }
+        }
+
+        return maximum_;
+    }
+
+  private:
+    static const int SUB_BUCKET_BITS_ = 4;
+    static const std::uint64_t SUB_BUCKET_COUNT_ = 1 << SUB_BUCKET_BITS_;
+    static const std::size_t BUCKET_COUNT_ =
+        (64 - SUB_BUCKET_BITS_ + 1) * SUB_BUCKET_COUNT_;
+
+    /* values below SUB_BUCKET_COUNT_ get a bucket each. larger values are
+     shifted right until their top SUB_BUCKET_BITS_ + 1 bits remain. */
+    static std::size_t to_index_(std::uint64_t value) {
+        if (value < SUB_BUCKET_COUNT_) {
+            return value;
+        }
+        int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS_;
+        return shift * SUB_BUCKET_COUNT_ + (value >> shift);
+    }
+
+    static std::uint64_t to_highest_value_(std::size_t index) {
+        if (index < SUB_BUCKET_COUNT_) {
+            return index;
+        }
+        int shift = index / SUB_BUCKET_COUNT_ - 1;
+        std::uint64_t mantissa = index % SUB_BUCKET_COUNT_ + SUB_BUCKET_COUNT_;
+        return (mantissa << shift) + ((std::uint64_t(1) << shift) - 1);
+    }
+
+    std::array<std::uint64_t, BUCKET_COUNT_> buckets_;
+    std::uint64_t count_;
+    std::uint64_t total_;
+    std::uint64_t maximum_;
+};
+
+#endif /* DYNAMISMTRACER_HISTOGRAM_H */
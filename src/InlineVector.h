@@ -0,0 +1,141 @@
+#ifndef DYNAMISMTRACER_INLINE_VECTOR_H
+#define DYNAMISMTRACER_INLINE_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+/* A vector that keeps up to N elements in place and only allocates on the
+   heap when it grows beyond that. It is meant for the short position
+   sequences of calls, which almost never exceed a handful of elements, so
+   it only supports trivially copyable elements. */
+template <typename T, std::size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "inline vector elements have to be trivially copyable");
+
+  public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    InlineVector(): size_(0), capacity_(N), data_(storage_) {
+    }
+
+    InlineVector(std::initializer_list<T> values): InlineVector() {
+        reserve(values.size());
+        std::copy(values.begin(), values.end(), data_);
+        size_ = values.size();
+    }
+
+    InlineVector(const InlineVector& other): InlineVector() {
+        reserve(other.size_);
+        std::copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    InlineVector& operator=(const InlineVector& other) {
+        if (this != &other) {
+            size_ = 0;
+            reserve(other.size_);
+            std::copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(std::initializer_list<T> values) {
+        size_ = 0;
+        reserve(values.size());
+        std::copy(values.begin(), values.end(), data_);
+        size_ = values.size();
+        return *this;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    bool is_inline() const {
+        return data_ == storage_;
+    }
+
+    void reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+
+        std::unique_ptr<T[]> heap(new T[capacity]);
+        std::copy(begin(), end(), heap.get());
+        heap_ = std::move(heap);
+        data_ = heap_.get();
+        capacity_ = capacity;
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            reserve(2 * capacity_);
+        }
+        data_[size_++] = value;
+    }
+
+    void clear() {
+        size_ = 0;
+    }
+
+    T& operator[](std::size_t index) {
+        return data_[index];
+    }
+
+    const T& operator[](std::size_t index) const {
+        return data_[index];
+    }
+
+    const T& back() const {
+        return data_[size_ - 1];
+    }
+
+    iterator begin() {
+        return data_;
+    }
+
+    iterator end() {
+        return data_ + size_;
+    }
+
+    const_iterator begin() const {
+        return data_;
+    }
+
+    const_iterator end() const {
+        return data_ + size_;
+    }
+
+  private:
+    std::size_t size_;
+    std::size_t capacity_;
+    T* data_;
+    std::unique_ptr<T[]> heap_;
+    T storage_[N];
+};
+
+template <typename T, std::size_t N>
+bool operator==(const InlineVector<T, N>& left,
+                const InlineVector<T, N>& right) {
+    return left.size() == right.size() &&
+           std::equal(left.begin(), left.end(), right.begin());
+}
+
+template <typename T, std::size_t N>
+bool operator!=(const InlineVector<T, N>& left,
+                const InlineVector<T, N>& right) {
+    return !(left == right);
+}
+
+#endif /* DYNAMISMTRACER_INLINE_VECTOR_H */
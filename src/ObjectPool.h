@@ -0,0 +1,99 @@
+#ifndef DYNAMISMTRACER_OBJECT_POOL_H
+#define DYNAMISMTRACER_OBJECT_POOL_H
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* A typed pool that hands out memory for objects of type T from slabs of
+   slab_size objects. Freed objects are threaded onto a free list and their
+   memory is recycled by the next allocation, so steady state tracing does
+   not touch the system allocator at all. Slabs are only released when the
+   pool is destroyed. */
+template <typename T>
+class ObjectPool {
+  public:
+    explicit ObjectPool(std::size_t slab_size)
+        : slab_size_(slab_size)
+        , free_list_(nullptr)
+        , slab_position_(slab_size)
+        , live_count_(0)
+        , high_water_mark_(0)
+        , allocation_count_(0) {
+    }
+
+    ObjectPool(const ObjectPool& other) = delete;
+
+    ObjectPool& operator=(const ObjectPool& other) = delete;
+
+    template <typename... Args>
+    T* allocate(Args&&... args) {
+        slot_t* slot = free_list_;
+
+        if (slot != nullptr) {
+            free_list_ = slot->next;
+        } else {
+            if (slab_position_ == slab_size_) {
+                slabs_.push_back(std::make_unique<slot_t[]>(slab_size_));
+                slab_position_ = 0;
+            }
+            slot = &slabs_.back()[slab_position_++];
+        }
+
+        ++allocation_count_;
+        ++live_count_;
+        high_water_mark_ = std::max(high_water_mark_, live_count_);
+
+        return new (&slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void deallocate(T* object) {
+        object->~T();
+        slot_t* slot = reinterpret_cast<slot_t*>(object);
+        slot->next = free_list_;
+        free_list_ = slot;
+        --live_count_;
+    }
+
+    std::size_t get_slab_size() const {
+        return slab_size_;
+    }
+
+    std::size_t get_slab_count() const {
+        return slabs_.size();
+    }
+
+    std::size_t get_capacity() const {
+        return get_slab_count() * get_slab_size();
+    }
+
+    std::size_t get_live_count() const {
+        return live_count_;
+    }
+
+    std::size_t get_high_water_mark() const {
+        return high_water_mark_;
+    }
+
+    std::size_t get_allocation_count() const {
+        return allocation_count_;
+    }
+
+  private:
+    union slot_t {
+        slot_t* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    const std::size_t slab_size_;
+    std::vector<std::unique_ptr<slot_t[]>> slabs_;
+    slot_t* free_list_;
+    std::size_t slab_position_;
+    std::size_t live_count_;
+    std::size_t high_water_mark_;
+    std::size_t allocation_count_;
+};
+
+#endif /* DYNAMISMTRACER_OBJECT_POOL_H */
@@ -0,0 +1,161 @@
+#include "ParallelReplayer.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include <sys/stat.h>
+
+ParallelReplayer::ParallelReplayer(TracerState& state,
+                                   std::size_t thread_count)
+    : state_(state), thread_count_(thread_count), next_trace_(0) {
+    if (thread_count_ == 0) {
+        thread_count_ = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+}
+
+void ParallelReplayer::add_log(const std::string& log_filepath,
+                               const std::string& trace_dirpath) {
+    struct stat status;
+
+    if (stat(log_filepath.c_str(), &status) == -1) {
+        dyntrace_log_error("unable to stat event log '%s'",
+                           log_filepath.c_str());
+        return;
+    }
+
+    Trace trace;
+    trace.log_filepath = log_filepath;
+    trace.trace_dirpath = trace_dirpath;
+    trace.log_size = status.st_size;
+    trace.finished = false;
+
+    traces_.push_back(std::move(trace));
+}
+
+void ParallelReplayer::replay() {
+    std::stable_sort(traces_.begin(),
+                     traces_.end(),
+                     [](const Trace& left, const Trace& right) {
+                         return left.log_size > right.log_size;
+                     });
+
+    state_.initialize();
+
+    thread_count_ =
+        std::min(thread_count_, std::max(traces_.size(), std::size_t(1)));
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < thread_count_; ++i) {
+        threads.emplace_back(&ParallelReplayer::replay_traces_, this);
+    }
+
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+
+    report_traces_();
+
+    /* the functions are sharded by id, so the shards are merged without
+       synchronization. */
+    std::vector<std::unordered_map<function_id_t, Function*>> shards(
+        thread_count_);
+
+    threads.clear();
+
+    for (std::size_t shard = 0; shard < thread_count_; ++shard) {
+        threads.emplace_back(&ParallelReplayer::merge_functions_,
+                             this,
+                             shard,
+                             std::ref(shards[shard]));
+    }
+
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+
+    for (const auto& shard: shards) {
+        for (const auto& binding: shard) {
+            state_.cache_function(binding.second);
+        }
+    }
+
+    /* serializes the merged function states. the names they refer to are
+       released afterwards. */
+    state_.cleanup(0);
+
+    traces_.clear();
+}
+
+void ParallelReplayer::replay_traces_() {
+    for (std::size_t index = next_trace_++; index < traces_.size();
+         index = next_trace_++) {
+        replay_trace_(traces_[index]);
+    }
+}
+
+/* runs on a worker thread. nothing here may call into R. */
+void ParallelReplayer::replay_trace_(Trace& trace) {
+    TracerState* trace_state = state_.clone(trace.trace_dirpath);
+    trace_state->retain_functions(trace.functions);
+
+    try {
+        Replayer replayer(trace.log_filepath, *trace_state);
+        replayer.replay();
+        trace.finished = replayer.is_finished();
+        trace.names = replayer.move_names();
+    } catch (const std::exception& e) {
+        trace.error = e.what();
+    }
+
+    if (trace.error.empty()) {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        state_.add_event_counts(*trace_state);
+    } else {
+        /* the retained functions refer to the names of the replayer. */
+        for (Function* function: trace.functions) {
+            delete function;
+        }
+        trace.functions.clear();
+    }
+
+    delete trace_state;
+}
+
+void ParallelReplayer::report_traces_() const {
+    for (const Trace& trace: traces_) {
+        if (!trace.error.empty()) {
+            dyntrace_log_warning("event log '%s' is left out: %s",
+                                 trace.log_filepath.c_str(),
+                                 trace.error.c_str());
+        } else if (!trace.finished) {
+            dyntrace_log_warning(
+                "event log '%s' ends before the end of tracing",
+                trace.log_filepath.c_str());
+        }
+    }
+}
+
+void ParallelReplayer::merge_functions_(
+    std::size_t shard,
+    std::unordered_map<function_id_t, Function*>& functions) {
+    const std::hash<function_id_t> hash;
+
+    /* the traces are merged in the same order on every run, so the merged
+       names and summaries are in a deterministic order. */
+    for (const Trace& trace: traces_) {
+        for (Function* function: trace.functions) {
+            if (hash(function->get_id()) % thread_count_ != shard) {
+                continue;
+            }
+
+            auto result = functions.insert({function->get_id(), function});
+
+            if (!result.second) {
+                result.first->second->merge(*function);
+                delete function;
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef DYNAMISMTRACER_PARALLEL_REPLAYER_H
+#define DYNAMISMTRACER_PARALLEL_REPLAYER_H
+
+#include "Replayer.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/* Replays a batch of independent event logs on a pool of threads. Each log
+ is replayed into a private clone of the tracer state that writes the
+ per-trace tables to the directory of the trace. The function states of the
+ clones are retained and merged by function id into the tracer state of the
+ batch, which writes the call summaries and function definitions of the
+ whole batch along with the summed event counts.
+
+ Threads take the next unclaimed log from a shared cursor, so a thread that
+ is done with a short log moves on while others are busy with long ones. The
+ logs are claimed in order of decreasing size to keep the largest logs from
+ being replayed last. A log that cannot be replayed is left out of the merge
+ and reported once all the threads are done. */
+class ParallelReplayer {
+  public:
+    ParallelReplayer(TracerState& state, std::size_t thread_count);
+
+    void add_log(const std::string& log_filepath,
+                 const std::string& trace_dirpath);
+
+    void replay();
+
+  private:
+    struct Trace {
+        std::string log_filepath;
+        std::string trace_dirpath;
+        std::size_t log_size;
+        /* the replay runs off the R thread, so its outcome is reported to R
+           after the threads are joined. */
+        std::string error;
+        bool finished;
+        std::vector<Function*> functions;
+        /* the names the functions refer to. */
+        std::deque<std::string> names;
+    };
+
+    void replay_traces_();
+
+    void replay_trace_(Trace& trace);
+
+    void report_traces_() const;
+
+    void merge_functions_(std::size_t shard,
+                          std::unordered_map<function_id_t, Function*>&
+                              functions);
+
+    TracerState& state_;
+    std::size_t thread_count_;
+    std::vector<Trace> traces_;
+    std::atomic<std::size_t> next_trace_;
+    /* guards the event counts of state_. */
+    std::mutex state_mutex_;
+};
+
+#endif /* DYNAMISMTRACER_PARALLEL_REPLAYER_H */
@@ -0,0 +1,327 @@
+#ifndef DYNAMISMTRACER_RECORDER_H
+#define DYNAMISMTRACER_RECORDER_H
+
+#include "Clock.h"
+#include "EventLog.h"
+#include "Function.h"
+#include "SexpMap.h"
+#include "sexptypes.h"
+#include "stdlibs.h"
+#include "utilities.h"
+
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+/* The state of the tracer in record mode. The probes do not analyze
+ anything, they only append the information the analyses need to the event
+ log. Functions, names and contexts are logged once and referred to by id
+ afterwards. The log is turned into the analysis tables by the Replayer. */
+class Recorder {
+  public:
+    Recorder(const std::string& output_dirpath, ClockType clock_type)
+        : output_dirpath_(output_dirpath)
+        , log_(output_dirpath + "/" + EVENT_LOG_FILENAME)
+        , clock_(clock_type)
+        , last_time_(0)
+        , next_function_ref_(0)
+        , next_name_ref_(0)
+        , next_context_ref_(0)
+        , eval_count_(0)
+        , unlogged_gc_unmark_count_(0) {
+    }
+
+    const std::string& get_output_dirpath() const {
+        return output_dirpath_;
+    }
+
+    void initialize() {
+        clock_.calibrate();
+        serialize_configuration_();
+        last_time_ = clock_.now();
+        record_event_(Event::DyntraceEntry);
+    }
+
+    void cleanup(int error) {
+        log_.write_byte(to_underlying(EventLogRecord::Counts));
+        log_.write_varint(eval_count_);
+        log_.write_varint(unlogged_gc_unmark_count_);
+
+        record_event_(Event::DyntraceExit);
+        log_.write_byte(error ? 1 : 0);
+
+        log_.close();
+
+        if (error) {
+            std::ofstream error_file(get_output_dirpath() + "/ERROR");
+            error_file << "ERROR";
+            error_file.close();
+        } else {
+            std::ofstream noerror_file(get_output_dirpath() + "/NOERROR");
+            noerror_file << "NOERROR";
+            noerror_file.close();
+        }
+    }
+
+    /* evals are only counted, like in analysis mode. */
+    void count_eval() {
+        ++eval_count_;
+    }
+
+    void record_call_entry(const Event event,
+                           const SEXP call,
+                           const SEXP op,
+                           const SEXP args,
+                           const SEXP rho,
+                           const dyntrace_dispatch_t dispatch) {
+        /* the records of the function and the name have to precede the
+         probe record that refers to them. */
+        const char* function_name = get_name(call);
+        const std::uint64_t function_ref = intern_function_(op);
+        const std::uint64_t name_ref = intern_name_(function_name);
+
+        record_event_(event);
+        log_.write_varint(function_ref);
+        log_.write_varint(name_ref);
+        log_.write_byte(dispatch);
+
+        if (event == Event::ClosureEntry) {
+            record_missing_argument_positions_(op, rho);
+            log_.write_byte(is_dynamic_closure_call_(function_name, op, rho));
+        } else if (event == Event::SpecialEntry) {
+            log_.write_byte(super_assigns_[function_ref] &&
+                            is_function_definition(CADR(args)));
+        }
+    }
+
+    void record_call_exit(const Event event, const SEXP return_value) {
+        record_event_(event);
+        log_.write_varint(type_of_sexp(return_value));
+    }
+
+    /* R contexts live on the C stack, so their addresses are reused. a
+     context gets a fresh id every time it is entered. */
+    void record_context_entry(const RCNTXT* context) {
+        const std::uint64_t context_ref = next_context_ref_++;
+        context_refs_[context] = context_ref;
+
+        record_event_(Event::ContextEntry);
+        log_.write_varint(context_ref);
+    }
+
+    void record_context_exit(const RCNTXT* context) {
+        context_refs_.erase(context);
+        record_event_(Event::ContextExit);
+    }
+
+    void record_context_jump(const RCNTXT* context, const SEXP return_value) {
+        auto iter = context_refs_.find(context);
+
+        if (iter == context_refs_.end()) {
+            dyntrace_log_error("jump to a context that was not recorded");
+            return;
+        }
+
+        record_event_(Event::ContextJump);
+        log_.write_varint(iter->second);
+        log_.write_varint(type_of_sexp(return_value));
+    }
+
+    /* only the reclamation of logged closures matters to the replay. the
+     others are counted. */
+    void record_gc_unmark(const SEXP object) {
+        if (type_of_sexp(object) == CLOSXP) {
+            auto iter = function_refs_.find(object);
+
+            if (iter != function_refs_.end()) {
+                record_event_(Event::GcUnmark);
+                log_.write_varint(iter->second);
+                function_refs_.erase(iter);
+                return;
+            }
+        }
+
+        ++unlogged_gc_unmark_count_;
+    }
+
+  private:
+    void record_event_(const Event event) {
+        const std::uint64_t time = clock_.now();
+        log_.write_byte(to_underlying(event));
+        log_.write_varint(clock_.to_nanoseconds(time - last_time_));
+        last_time_ = time;
+    }
+
+    std::uint64_t intern_function_(const SEXP op) {
+        auto iter = function_refs_.find(op);
+
+        if (iter != function_refs_.end()) {
+            return iter->second;
+        }
+
+        const auto [package_name, function_id] =
+            Function::compute_namespace_and_id(op);
+
+        /* closures are only deparsed the first time their id is seen. the
+         replay remembers the definition for the closures that follow. */
+        const bool defined = defined_function_ids_.insert(function_id).second;
+
+        const Function function(op,
+                                package_name,
+                                defined ? Function::compute_definition(op) : "",
+                                function_id);
+
+        const std::uint64_t function_ref = next_function_ref_++;
+        function_refs_.insert({op, function_ref});
+        super_assigns_.push_back(function.is_super_assign());
+
+        log_.write_byte(to_underlying(EventLogRecord::Function));
+        log_.write_varint(function_ref);
+        log_.write_string(function.get_id());
+        log_.write_string(function.get_namespace());
+        log_.write_varint(function.get_type());
+        log_.write_varint(function.get_formal_parameter_count());
+        log_.write_byte(function.is_byte_compiled());
+        log_.write_signed_varint(function.get_primitive_offset());
+
+        const pos_seq_t& force_order = function.get_primitive_force_order();
+        log_.write_varint(force_order.size());
+        for (int position: force_order) {
+            log_.write_signed_varint(position);
+        }
+
+        log_.write_string(function.get_definition());
+
+        return function_ref;
+    }
+
+    /* names are interned by R, so they are logged once per address. */
+    std::uint64_t intern_name_(const char* name) {
+        auto iter = name_refs_.find(name);
+
+        if (iter != name_refs_.end()) {
+            return iter->second;
+        }
+
+        const std::uint64_t name_ref = next_name_ref_++;
+        name_refs_.insert({name, name_ref});
+
+        log_.write_byte(to_underlying(EventLogRecord::Name));
+        log_.write_varint(name_ref);
+        log_.write_string(name);
+
+        return name_ref;
+    }
+
+    /* the formal parameter positions bound to missing arguments. these are
+     the positions the analysis mode reports for the call. */
+    void record_missing_argument_positions_(const SEXP op, const SEXP rho) {
+        missing_argument_positions_.clear();
+
+        int formal_parameter_position = -1;
+
+        for (SEXP formal = FORMALS(op); formal != R_NilValue;
+             formal = CDR(formal)) {
+            ++formal_parameter_position;
+
+            const SEXP argument = dyntrace_lookup_environment(rho, TAG(formal));
+            bool missing = false;
+
+            if (type_of_sexp(argument) == DOTSXP) {
+                for (SEXP dots = argument; dots != R_NilValue;
+                     dots = CDR(dots)) {
+                    missing = missing || type_of_sexp(CAR(dots)) == MISSINGSXP;
+                }
+            } else {
+                missing = type_of_sexp(argument) == MISSINGSXP;
+            }
+
+            if (missing) {
+                missing_argument_positions_.push_back(
+                    formal_parameter_position);
+            }
+        }
+
+        log_.write_varint(missing_argument_positions_.size());
+        for (int position: missing_argument_positions_) {
+            log_.write_varint(position);
+        }
+    }
+
+    /* like the analysis mode, assign and with calls are dynamic if their
+     second argument is a function definition. */
+    bool is_dynamic_closure_call_(const char* function_name,
+                                  const SEXP op,
+                                  const SEXP rho) const {
+        if (strcmp(function_name, "assign") != 0 &&
+            strcmp(function_name, "with") != 0) {
+            return false;
+        }
+
+        auto is_function_definition_promise = [](const SEXP argument) {
+            return type_of_sexp(argument) == PROMSXP &&
+                   is_function_definition(
+                       dyntrace_get_promise_expression(argument));
+        };
+
+        int actual_argument_position = -1;
+
+        for (SEXP formal = FORMALS(op); formal != R_NilValue;
+             formal = CDR(formal)) {
+            const SEXP argument =
+                dyntrace_lookup_environment(rho, TAG(formal));
+
+            if (type_of_sexp(argument) != DOTSXP) {
+                if (++actual_argument_position == 1) {
+                    return is_function_definition_promise(argument);
+                }
+                continue;
+            }
+
+            for (SEXP dots = argument; dots != R_NilValue; dots = CDR(dots)) {
+                if (++actual_argument_position == 1) {
+                    return is_function_definition_promise(CAR(dots));
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void serialize_configuration_() const {
+        std::ofstream fout(get_output_dirpath() + "/CONFIGURATION",
+                           std::ios::trunc);
+
+        auto serialize_row = [&fout](const std::string& key,
+                                     const std::string& value) {
+            fout << key << "=" << value << std::endl;
+        };
+
+        serialize_row("GIT_COMMIT_INFO", GIT_COMMIT_INFO);
+        serialize_row("mode", "record");
+        serialize_row("clock", to_string(clock_.get_type()));
+        if (clock_.get_type() == ClockType::Tsc) {
+            serialize_row("tsc_frequency",
+                          std::to_string(clock_.get_tsc_frequency()));
+        }
+    }
+
+    const std::string output_dirpath_;
+    EventLogWriter log_;
+    Clock clock_;
+    std::uint64_t last_time_;
+    std::uint64_t next_function_ref_;
+    std::uint64_t next_name_ref_;
+    std::uint64_t next_context_ref_;
+    std::uint64_t eval_count_;
+    std::uint64_t unlogged_gc_unmark_count_;
+    SexpMap<std::uint64_t> function_refs_;
+    std::unordered_set<function_id_t> defined_function_ids_;
+    /* whether the function of each ref is '<<-'. */
+    std::vector<bool> super_assigns_;
+    std::unordered_map<const char*, std::uint64_t> name_refs_;
+    std::unordered_map<const RCNTXT*, std::uint64_t> context_refs_;
+    pos_seq_t missing_argument_positions_;
+};
+
+#endif /* DYNAMISMTRACER_RECORDER_H */
@@ -0,0 +1,331 @@
+#include "Replayer.h"
+
+void Replayer::replay() {
+    while (!log_.is_at_end()) {
+        const std::uint8_t tag = log_.read_byte();
+
+        if (tag < to_underlying(Event::COUNT)) {
+            /* the time since the previous record. the replayed analyses do
+             not measure time. */
+            log_.read_varint();
+            replay_event_(static_cast<Event>(tag));
+            continue;
+        }
+
+        switch (static_cast<EventLogRecord>(tag)) {
+        case EventLogRecord::Name:
+            replay_name_();
+            break;
+        case EventLogRecord::Function:
+            replay_function_();
+            break;
+        case EventLogRecord::Counts:
+            replay_counts_();
+            break;
+        default:
+            throw EventLogError("unknown event log record " +
+                                std::to_string(tag));
+        }
+    }
+
+    /* the traced process was interrupted before the tracer exited. the
+     frames left on the stack are exited as if they were jumped over. */
+    if (!finished_) {
+        execution_contexts_t exec_ctxts;
+
+        while (!state_.get_stack_().is_empty()) {
+            exec_ctxts.push_back(state_.pop_stack());
+        }
+
+        jump_contexts(state_, exec_ctxts, JUMPSXP, nullptr);
+
+        state_.cleanup(1);
+    }
+}
+
+void Replayer::replay_name_() {
+    const std::uint64_t name_ref = log_.read_varint();
+
+    if (name_ref != names_.size()) {
+        throw EventLogError("event log names are out of order");
+    }
+
+    names_.push_back(log_.read_string());
+}
+
+void Replayer::replay_function_() {
+    const std::uint64_t function_ref = log_.read_varint();
+    const function_id_t function_id = log_.read_string();
+    const std::string package_name = log_.read_string();
+    const sexptype_t type = log_.read_varint();
+    const std::size_t formal_parameter_count = log_.read_varint();
+    const bool byte_compiled = log_.read_byte();
+    const int primitive_offset = log_.read_signed_varint();
+
+    pos_seq_t primitive_force_order;
+    const std::size_t force_order_size = log_.read_varint();
+    for (std::size_t i = 0; i < force_order_size; ++i) {
+        primitive_force_order.push_back(log_.read_signed_varint());
+    }
+
+    std::string definition = log_.read_string();
+
+    if (!definition.empty()) {
+        definitions_[function_id] = definition;
+    }
+
+    Function* function = state_.lookup_cached_function(function_id);
+
+    /* a new function state is cached by the call entry that follows, once
+     the name it is called by is known. */
+    if (function == nullptr) {
+        function = new Function(type,
+                                formal_parameter_count,
+                                byte_compiled,
+                                primitive_offset,
+                                primitive_force_order,
+                                package_name,
+                                definitions_[function_id],
+                                function_id);
+        uncached_function_ = function;
+    }
+
+    function->add_reference();
+    functions_[function_ref] = function;
+}
+
+void Replayer::replay_counts_() {
+    state_.count_event(Event::EvalEntry, log_.read_varint());
+    state_.count_event(Event::GcUnmark, log_.read_varint());
+}
+
+void Replayer::replay_event_(const Event event) {
+    switch (event) {
+    case Event::DyntraceEntry:
+        state_.initialize();
+        state_.exit_probe(Event::DyntraceEntry);
+        break;
+    case Event::DyntraceExit:
+        replay_dyntrace_exit_();
+        break;
+    case Event::ClosureEntry:
+    case Event::BuiltinEntry:
+    case Event::SpecialEntry:
+        replay_call_entry_(event);
+        break;
+    case Event::ClosureExit:
+    case Event::BuiltinExit:
+    case Event::SpecialExit:
+        replay_call_exit_(event);
+        break;
+    case Event::ContextEntry:
+        replay_context_entry_();
+        break;
+    case Event::ContextJump:
+        replay_context_jump_();
+        break;
+    case Event::ContextExit:
+        replay_context_exit_();
+        break;
+    case Event::GcUnmark:
+        replay_gc_unmark_();
+        break;
+    default:
+        throw EventLogError("unexpected event '" + to_string(event) +
+                            "' in event log");
+    }
+}
+
+void Replayer::replay_call_entry_(const Event event) {
+    Function* function = get_function_(log_.read_varint());
+    const std::uint64_t name_ref = log_.read_varint();
+    const dyntrace_dispatch_t dispatch =
+        static_cast<dyntrace_dispatch_t>(log_.read_byte());
+
+    missing_argument_positions_.clear();
+
+    if (event == Event::ClosureEntry) {
+        const std::size_t count = log_.read_varint();
+        for (std::size_t i = 0; i < count; ++i) {
+            missing_argument_positions_.push_back(log_.read_varint());
+        }
+    }
+
+    const bool dynamic_call =
+        event != Event::BuiltinEntry && log_.read_byte() != 0;
+
+    if (name_ref >= names_.size()) {
+        throw EventLogError("event log refers to an unknown name");
+    }
+
+    const char* function_name = names_[name_ref].c_str();
+
+    state_.enter_probe(event);
+
+    if (function == uncached_function_) {
+        function->add_name(function_name);
+        state_.cache_function(function);
+        uncached_function_ = nullptr;
+    }
+
+    if (!state_.needs_call(function)) {
+        state_.push_stack(function, function_name, nullptr, dispatch);
+    } else {
+        Call* function_call = state_.create_call(
+            function, function_name, missing_argument_positions_);
+
+        set_dispatch(function_call, dispatch);
+
+        if (dynamic_call) {
+            function_call->set_dynamic_call();
+        }
+
+        state_.push_stack(function_call);
+    }
+
+    state_.exit_probe(event);
+}
+
+void Replayer::replay_call_exit_(const Event event) {
+    const sexptype_t return_value_type = log_.read_varint();
+
+    check_stack_();
+
+    state_.enter_probe(event);
+
+    ExecutionContext exec_ctxt = state_.pop_stack();
+
+    if (!exec_ctxt.is_call()) {
+        throw EventLogError("event log exits a call that is not on the stack");
+    }
+
+    exit_call(state_, exec_ctxt, return_value_type);
+
+    state_.exit_probe(event);
+}
+
+void Replayer::replay_context_entry_() {
+    const std::uint64_t context_ref = log_.read_varint();
+
+    state_.enter_probe(Event::ContextEntry);
+
+    const RCNTXT* context = &contexts_[context_ref];
+    context_refs_[context] = context_ref;
+    state_.push_stack(context);
+
+    state_.exit_probe(Event::ContextEntry);
+}
+
+void Replayer::replay_context_jump_() {
+    const std::uint64_t context_ref = log_.read_varint();
+    const sexptype_t return_value_type = log_.read_varint();
+
+    auto iter = contexts_.find(context_ref);
+
+    if (iter == contexts_.end() || !is_on_stack_(&iter->second)) {
+        throw EventLogError("event log jumps to an unknown context");
+    }
+
+    state_.enter_probe(Event::ContextJump);
+
+    execution_contexts_t exec_ctxts(state_.unwind_stack(&iter->second));
+
+    jump_contexts(state_, exec_ctxts, return_value_type, nullptr);
+
+    /* the contexts jumped over do not exit. */
+    for (const ExecutionContext& exec_ctxt: exec_ctxts) {
+        if (exec_ctxt.is_r_context()) {
+            release_context_(exec_ctxt.get_r_context());
+        }
+    }
+
+    state_.exit_probe(Event::ContextJump);
+}
+
+void Replayer::replay_context_exit_() {
+    check_stack_();
+
+    state_.enter_probe(Event::ContextExit);
+
+    ExecutionContext exec_ctxt = state_.pop_stack();
+
+    if (!exec_ctxt.is_r_context()) {
+        throw EventLogError(
+            "event log exits a context that is not on the stack");
+    }
+
+    release_context_(exec_ctxt.get_r_context());
+
+    state_.exit_probe(Event::ContextExit);
+}
+
+void Replayer::replay_gc_unmark_() {
+    const std::uint64_t function_ref = log_.read_varint();
+
+    state_.enter_probe(Event::GcUnmark);
+
+    Function* function = get_function_(function_ref);
+    functions_.erase(function_ref);
+    state_.release_function(function);
+
+    state_.exit_probe(Event::GcUnmark);
+}
+
+void Replayer::replay_dyntrace_exit_() {
+    const int error = log_.read_byte();
+
+    /* cleanup reports a non empty stack to R, which must not happen off the
+     R thread, so the log is rejected before. */
+    if (!state_.get_stack_().is_empty()) {
+        throw EventLogError("event log exits the tracer with " +
+                            std::to_string(state_.get_stack_().size()) +
+                            " frames on the stack");
+    }
+
+    state_.enter_probe(Event::DyntraceExit);
+
+    state_.cleanup(error);
+
+    finished_ = true;
+}
+
+Function* Replayer::get_function_(std::uint64_t function_ref) {
+    auto iter = functions_.find(function_ref);
+
+    if (iter == functions_.end()) {
+        throw EventLogError("event log refers to an unknown function");
+    }
+
+    return iter->second;
+}
+
+void Replayer::check_stack_() {
+    if (state_.get_stack_().is_empty()) {
+        throw EventLogError("event log exits a frame from an empty stack");
+    }
+}
+
+/* the target of a jump is usually close to the top of the stack, where the
+ search starts, so the search costs about as much as the unwinding. */
+bool Replayer::is_on_stack_(const RCNTXT* context) {
+    ExecutionContextStack& stack = state_.get_stack_();
+
+    for (std::size_t index = stack.size(); index > 0; --index) {
+        const ExecutionContext& exec_ctxt = stack.get(index - 1);
+
+        if (exec_ctxt.is_r_context() && exec_ctxt.get_r_context() == context) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Replayer::release_context_(const RCNTXT* context) {
+    auto iter = context_refs_.find(context);
+
+    if (iter != context_refs_.end()) {
+        contexts_.erase(iter->second);
+        context_refs_.erase(iter);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef DYNAMISMTRACER_REPLAYER_H
+#define DYNAMISMTRACER_REPLAYER_H
+
+#include "EventLog.h"
+#include "probes.h"
+
+#include <deque>
+#include <unordered_map>
+
+/* Replays an event log written in record mode into a TracerState, which
+ writes the analysis tables as if the expression had been traced in
+ analysis mode. The replay goes through the same stack bookkeeping as the
+ probes, with the functions, names and contexts restored from the log
+ instead of looked up from R objects.
+
+ The log holds what the call stack needs, so the event counts, call
+ summaries, dynamic call summaries and function definitions are reproduced.
+ Closure and special calls are logged with whether they define a function
+ dynamically, which is all the dynamic call analysis reads from their
+ arguments. Arguments, promises and side effects need R objects that the
+ log does not capture, so these analyses cannot be replayed. */
+class Replayer {
+  public:
+    Replayer(const std::string& log_filepath, TracerState& state)
+        : log_(log_filepath)
+        , state_(state)
+        , finished_(false)
+        , uncached_function_(nullptr) {
+    }
+
+    /* throws an EventLogError if the log cannot be replayed. */
+    void replay();
+
+    /* false if the log ends before the end of tracing, when the traced
+       process was interrupted. the state is cleaned up in either case. */
+    bool is_finished() const {
+        return finished_;
+    }
+
+    /* the function states of the replay refer to these names. moving the
+       deque keeps them at the same addresses. */
+    std::deque<std::string> move_names() {
+        return std::move(names_);
+    }
+
+  private:
+    void replay_name_();
+
+    void replay_function_();
+
+    void replay_counts_();
+
+    void replay_event_(const Event event);
+
+    void replay_call_entry_(const Event event);
+
+    void replay_call_exit_(const Event event);
+
+    void replay_context_entry_();
+
+    void replay_context_jump_();
+
+    void replay_context_exit_();
+
+    void replay_gc_unmark_();
+
+    void replay_dyntrace_exit_();
+
+    Function* get_function_(std::uint64_t function_ref);
+
+    void check_stack_();
+
+    bool is_on_stack_(const RCNTXT* context);
+
+    void release_context_(const RCNTXT* context);
+
+    EventLogReader log_;
+    TracerState& state_;
+    bool finished_;
+    /* the names are referred to by address, like the names interned by R.
+     a deque does not move its elements when it grows. */
+    std::deque<std::string> names_;
+    std::unordered_map<std::uint64_t, Function*> functions_;
+    /* definitions are only logged with the first function of each id. */
+    std::unordered_map<function_id_t, std::string> definitions_;
+    /* the function state created by the last function record, if it is not
+     cached yet. */
+    Function* uncached_function_;
+    /* stand-ins for the R contexts. only their addresses are used, to match
+     jumps with the stack frames of their contexts. */
+    std::unordered_map<std::uint64_t, RCNTXT> contexts_;
+    std::unordered_map<const RCNTXT*, std::uint64_t> context_refs_;
+    pos_seq_t missing_argument_positions_;
+};
+
+#endif /* DYNAMISMTRACER_REPLAYER_H */
@@ -0,0 +1,35 @@
+#ifndef DYNAMISMTRACER_SAMPLING_H
+#define DYNAMISMTRACER_SAMPLING_H
+
+#include "stdlibs.h"
+
+#include <string>
+
+/* The unit over which closure calls are sampled. With a sampling rate of N,
+ one in N calls of each function, or of each call site, is traced in full. */
+enum class SamplingUnit { Function = 0, CallSite, COUNT };
+
+inline std::string to_string(const SamplingUnit sampling_unit) {
+    switch (sampling_unit) {
+    case SamplingUnit::Function:
+        return "function";
+    case SamplingUnit::CallSite:
+        return "call_site";
+    case SamplingUnit::COUNT:
+        return "unknown_sampling_unit";
+    }
+
+    return "unknown_sampling_unit";
+}
+
+/* returns SamplingUnit::COUNT if the name does not denote a sampling unit. */
+inline SamplingUnit string_to_sampling_unit(const std::string& name) {
+    for (int i = 0; i < static_cast<int>(SamplingUnit::COUNT); ++i) {
+        if (to_string(static_cast<SamplingUnit>(i)) == name) {
+            return static_cast<SamplingUnit>(i);
+        }
+    }
+    return SamplingUnit::COUNT;
+}
+
+#endif /* DYNAMISMTRACER_SAMPLING_H */
@@ -0,0 +1,330 @@
+#ifndef DYNAMISMTRACER_SEXP_MAP_H
+#define DYNAMISMTRACER_SEXP_MAP_H
+
+#include "stdlibs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/* A hash map from R object addresses to tracer state. It uses open
+   addressing with linear probing over a flat array of keys, so a lookup
+   touches one or two cache lines and no per entry nodes are allocated.
+   Deletion shifts the following entries of the probe sequence backwards
+   instead of leaving tombstones behind, which keeps probe sequences short
+   on maps with heavy insertion and deletion traffic like the promise map.
+   The null pointer is reserved to mark empty slots and cannot be used as
+   a key. A map constructed without a bucket count allocates its table on
+   the first insertion, so empty maps are free. */
+template <typename V>
+class SexpMap {
+  public:
+    using key_type = SEXP;
+    using mapped_type = V;
+    using value_type = std::pair<SEXP, V>;
+
+    template <typename M, typename T>
+    class basic_iterator {
+      public:
+        basic_iterator(M* map, std::size_t index): map_(map), index_(index) {
+            skip_empty_slots_();
+        }
+
+        T& operator*() const {
+            return map_->values_[index_];
+        }
+
+        T* operator->() const {
+            return &map_->values_[index_];
+        }
+
+        basic_iterator& operator++() {
+            ++index_;
+            skip_empty_slots_();
+            return *this;
+        }
+
+        bool operator==(const basic_iterator& other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const basic_iterator& other) const {
+            return index_ != other.index_;
+        }
+
+      private:
+        void skip_empty_slots_() {
+            while (index_ < map_->capacity_ && map_->keys_[index_] == nullptr) {
+                ++index_;
+            }
+        }
+
+        M* map_;
+        std::size_t index_;
+
+        friend class SexpMap;
+    };
+
+    using iterator = basic_iterator<SexpMap, value_type>;
+    using const_iterator = basic_iterator<const SexpMap, const value_type>;
+
+    explicit SexpMap(std::size_t bucket_count = 0)
+        : keys_(nullptr), values_(nullptr), capacity_(0), shift_(64), size_(0) {
+        if (bucket_count > 0) {
+            allocate_(compute_capacity_(bucket_count));
+        }
+    }
+
+    SexpMap(const SexpMap& other) = delete;
+
+    SexpMap& operator=(const SexpMap& other) = delete;
+
+    SexpMap(SexpMap&& other)
+        : keys_(other.keys_)
+        , values_(other.values_)
+        , capacity_(other.capacity_)
+        , shift_(other.shift_)
+        , size_(other.size_) {
+        other.keys_ = nullptr;
+        other.values_ = nullptr;
+        other.capacity_ = 0;
+        other.shift_ = 64;
+        other.size_ = 0;
+    }
+
+    ~SexpMap() {
+        clear();
+        deallocate_(keys_, values_, capacity_);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    std::size_t bucket_count() const {
+        return capacity_;
+    }
+
+    /* the bytes held by the slots of the map. memory owned by the values
+       themselves is not included. */
+    std::size_t get_memory_usage() const {
+        return capacity_ * (sizeof(SEXP) + sizeof(V));
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, capacity_);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, capacity_);
+    }
+
+    iterator find(const SEXP key) {
+        return iterator(this, find_index_(key));
+    }
+
+    const_iterator find(const SEXP key) const {
+        return const_iterator(this, find_index_(key));
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        std::size_t index = find_index_(value.first);
+
+        if (index != capacity_) {
+            return {iterator(this, index), false};
+        }
+
+        reserve(size_ + 1);
+        index = find_free_index_(value.first);
+        construct_(index, std::move(value));
+        return {iterator(this, index), true};
+    }
+
+    std::pair<iterator, bool> insert_or_assign(const SEXP key, V value) {
+        std::size_t index = find_index_(key);
+
+        if (index != capacity_) {
+            values_[index].second = std::move(value);
+            return {iterator(this, index), false};
+        }
+
+        return insert(value_type(key, std::move(value)));
+    }
+
+    std::size_t erase(const SEXP key) {
+        std::size_t index = find_index_(key);
+
+        if (index == capacity_) {
+            return 0;
+        }
+
+        erase_index_(index);
+        return 1;
+    }
+
+    void erase(iterator iter) {
+        erase_index_(iter.index_);
+    }
+
+    void clear() {
+        for (std::size_t index = 0; index < capacity_ && size_ > 0; ++index) {
+            if (keys_[index] != nullptr) {
+                destroy_(index);
+            }
+        }
+    }
+
+    /* grow the table if needed to hold count entries without exceeding
+       the maximum load factor. */
+    void reserve(std::size_t count) {
+        if (count * MAXIMUM_LOAD_FACTOR_DENOMINATOR_ <=
+            capacity_ * MAXIMUM_LOAD_FACTOR_NUMERATOR_) {
+            return;
+        }
+
+        std::size_t capacity = std::max(capacity_, MINIMUM_CAPACITY_);
+        while (count * MAXIMUM_LOAD_FACTOR_DENOMINATOR_ >
+               capacity * MAXIMUM_LOAD_FACTOR_NUMERATOR_) {
+            capacity *= 2;
+        }
+
+        rehash_(capacity);
+    }
+
+  private:
+    static std::size_t compute_capacity_(std::size_t bucket_count) {
+        std::size_t capacity = MINIMUM_CAPACITY_;
+        while (capacity < bucket_count) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    /* R objects are at least 8 byte aligned, so the low bits of the address
+       carry no information. Multiplying with the 64 bit golden ratio and
+       keeping the high bits spreads consecutively allocated objects evenly
+       over the table. */
+    std::size_t home_index_(const SEXP key) const {
+        std::uint64_t address = reinterpret_cast<std::uintptr_t>(key) >> 3;
+        return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ULL) >>
+                                        shift_);
+    }
+
+    std::size_t find_index_(const SEXP key) const {
+        if (size_ == 0) {
+            return capacity_;
+        }
+        const std::size_t mask = capacity_ - 1;
+        std::size_t index = home_index_(key);
+        while (keys_[index] != key) {
+            if (keys_[index] == nullptr) {
+                return capacity_;
+            }
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    std::size_t find_free_index_(const SEXP key) const {
+        const std::size_t mask = capacity_ - 1;
+        std::size_t index = home_index_(key);
+        while (keys_[index] != nullptr) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void construct_(std::size_t index, value_type&& value) {
+        keys_[index] = value.first;
+        new (&values_[index]) value_type(std::move(value));
+        ++size_;
+    }
+
+    void destroy_(std::size_t index) {
+        values_[index].~value_type();
+        keys_[index] = nullptr;
+        --size_;
+    }
+
+    /* backward shift deletion. after emptying a slot, every following entry
+       of the same run whose home slot does not lie cyclically between the
+       hole and its current slot is moved into the hole. */
+    void erase_index_(std::size_t hole) {
+        const std::size_t mask = capacity_ - 1;
+
+        destroy_(hole);
+
+        for (std::size_t index = (hole + 1) & mask; keys_[index] != nullptr;
+             index = (index + 1) & mask) {
+            std::size_t home = home_index_(keys_[index]);
+
+            if (((index - home) & mask) >= ((index - hole) & mask)) {
+                construct_(hole, std::move(values_[index]));
+                destroy_(index);
+                hole = index;
+            }
+        }
+    }
+
+    void allocate_(std::size_t capacity) {
+        keys_ = new SEXP[capacity]();
+        values_ = std::allocator<value_type>().allocate(capacity);
+        capacity_ = capacity;
+        shift_ = 64;
+        for (std::size_t c = capacity; c > 1; c /= 2) {
+            --shift_;
+        }
+    }
+
+    static void
+    deallocate_(SEXP* keys, value_type* values, std::size_t capacity) {
+        delete[] keys;
+        if (values != nullptr) {
+            std::allocator<value_type>().deallocate(values, capacity);
+        }
+    }
+
+    void rehash_(std::size_t capacity) {
+        SEXP* keys = keys_;
+        value_type* values = values_;
+        std::size_t old_capacity = capacity_;
+
+        allocate_(capacity);
+        size_ = 0;
+
+        for (std::size_t index = 0; index < old_capacity; ++index) {
+            if (keys[index] != nullptr) {
+                construct_(find_free_index_(keys[index]),
+                           std::move(values[index]));
+                values[index].~value_type();
+            }
+        }
+
+        deallocate_(keys, values, old_capacity);
+    }
+
+    SEXP* keys_;
+    value_type* values_;
+    std::size_t capacity_;
+    int shift_;
+    std::size_t size_;
+
+    static const std::size_t MINIMUM_CAPACITY_ = 16;
+    static const std::size_t MAXIMUM_LOAD_FACTOR_NUMERATOR_ = 1;
+    static const std::size_t MAXIMUM_LOAD_FACTOR_DENOMINATOR_ = 2;
+};
+
+#endif /* DYNAMISMTRACER_SEXP_MAP_H */
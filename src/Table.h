@@ -0,0 +1,132 @@
+#ifndef DYNAMISMTRACER_TABLE_H
+#define DYNAMISMTRACER_TABLE_H
+
+#include "Dictionary.h"
+#include "dynalyzer.h"
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/* A column of a table schema. The type of the column is only a tag, the
+   column itself holds its name so that schemas are constant expressions. */
+template <typename T>
+struct Column {
+    using type = T;
+    const char* name;
+};
+
+/* A schema is a struct with the NAME of its table and a tuple of COLUMNS.
+   The types of the columns are the types of the row that the table writer
+   queues, so a row is converted to the column types when it is written
+   and the conversions are not repeated at every call site. */
+template <typename Columns>
+struct schema_row;
+
+template <typename... Ts>
+struct schema_row<std::tuple<Column<Ts>...>> {
+    using type = std::tuple<Ts...>;
+};
+
+template <typename Schema>
+using schema_row_t =
+    typename schema_row<std::decay_t<decltype(Schema::COLUMNS)>>::type;
+
+template <typename Schema>
+std::vector<std::string> get_column_names() {
+    return std::apply(
+        [](const auto&... columns) {
+            return std::vector<std::string>{columns.name...};
+        },
+        Schema::COLUMNS);
+}
+
+/* a value can be written to a column if it converts to the type of the
+   column. bool columns only take bools and categories only take
+   categories, since anything converts to bool. */
+template <typename T, typename Arg>
+struct is_column_value
+    : std::integral_constant<bool,
+                             std::is_same<T, bool>::value
+                                 ? std::is_same<Arg, bool>::value
+                                 : !std::is_same<Arg, bool>::value &&
+                                       std::is_convertible<Arg, T>::value> {
+};
+
+template <typename Arg>
+struct is_column_value<Category, Arg>
+    : std::is_same<Arg, Category> {};
+
+template <typename Row, typename... Args>
+struct is_row;
+
+template <typename... Ts, typename... Args>
+struct is_row<std::tuple<Ts...>, Args...>
+    : std::integral_constant<
+          bool,
+          (is_column_value<Ts, std::decay_t<Args>>::value && ...)> {};
+
+template <typename Schema, typename... Args>
+constexpr void check_row() {
+    static_assert(sizeof...(Args) ==
+                      std::tuple_size<schema_row_t<Schema>>::value,
+                  "row does not have as many values as the table columns");
+    static_assert(is_row<schema_row_t<Schema>, Args...>::value,
+                  "row values do not match the table column types");
+}
+
+/* A data table with a schema. The table is created in the output
+   directory when constructed and closed when destroyed. */
+template <typename Schema>
+class Table {
+  public:
+    using row_t = schema_row_t<Schema>;
+
+    Table(const std::string& dirpath,
+          bool truncate,
+          bool binary,
+          int compression_level)
+        : Table(dirpath, Schema::NAME, truncate, binary, compression_level) {
+    }
+
+    Table(const std::string& dirpath,
+          const std::string& name,
+          bool truncate,
+          bool binary,
+          int compression_level)
+        : stream_(dynalyzer_create_data_table(dirpath + "/" + name,
+                                              get_column_names<Schema>(),
+                                              truncate,
+                                              binary,
+                                              compression_level)) {
+    }
+
+    Table(const Table& other) = delete;
+
+    Table& operator=(const Table& other) = delete;
+
+    ~Table() {
+        delete stream_;
+    }
+
+    DataTableStream* get_stream() {
+        return stream_;
+    }
+
+    /* writes a row without going through a table writer. */
+    template <typename... Args>
+    void write_row(Args&&... values) {
+        check_row<Schema, Args...>();
+        std::apply(
+            [this](const auto&... columns) {
+                stream_->write_row(to_column_value(columns)...);
+            },
+            row_t(std::forward<Args>(values)...));
+    }
+
+  private:
+    DataTableStream* stream_;
+};
+
+#endif /* DYNAMISMTRACER_TABLE_H */
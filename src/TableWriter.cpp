@@ -0,0 +1,64 @@
+#include "TableWriter.h"
+
+#include <chrono>
+
+/* time the writer thread sleeps when it finds the ring empty. */
+static const std::chrono::microseconds IDLE_SLEEP_DURATION(100);
+
+TableWriter::TableWriter(std::size_t queue_capacity, bool encode_categories)
+    : capacity_(0)
+    , encode_categories_(encode_categories)
+    , head_(0)
+    , tail_(0)
+    , cached_head_(0)
+    , row_count_(0)
+    , blocked_count_(0)
+    , stopping_(false) {
+    if (queue_capacity == 0) {
+        return;
+    }
+
+    /* a power of 2 capacity turns the modulo of the ring index into a mask. */
+    capacity_ = 1;
+    while (capacity_ < queue_capacity) {
+        capacity_ *= 2;
+    }
+
+    records_ = std::make_unique<record_t[]>(capacity_);
+    thread_ = std::thread(&TableWriter::run_, this);
+}
+
+void TableWriter::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    stopping_.store(true, std::memory_order_release);
+    thread_.join();
+}
+
+void TableWriter::run_() {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+
+    while (true) {
+        /* stopping is read before the tail so that all rows queued before
+           stop was called are seen. */
+        const bool stopping = stopping_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+        if (head == tail) {
+            if (stopping) {
+                return;
+            }
+            std::this_thread::sleep_for(IDLE_SLEEP_DURATION);
+            continue;
+        }
+
+        for (; head != tail; ++head) {
+            TableRow* row = reinterpret_cast<TableRow*>(
+                records_[head & (capacity_ - 1)].storage);
+            row->write(encode_categories_);
+            row->~TableRow();
+            head_.store(head + 1, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#ifndef DYNAMISMTRACER_TABLE_WRITER_H
+#define DYNAMISMTRACER_TABLE_WRITER_H
+
+#include "Dictionary.h"
+#include "Table.h"
+#include "dynalyzer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/* A row waiting in the queue of the table writer. It owns copies of the
+   column values and writes them to its table when the writer thread gets
+   to it. */
+class TableRow {
+  public:
+    virtual ~TableRow() {
+    }
+
+    virtual void write(bool encoded) = 0;
+};
+
+/* writes the codes of the categories if encoded, their values otherwise. */
+template <typename... Ts>
+void write_table_row(DataTableStream* table,
+                     bool encoded,
+                     const Ts&... values) {
+    if (encoded) {
+        table->write_row(to_column_code(values)...);
+    } else {
+        table->write_row(to_column_value(values)...);
+    }
+}
+
+/* the values are converted to the column types of the schema of the table
+   when the row is constructed. */
+template <typename Row>
+class TypedTableRow: public TableRow {
+  public:
+    template <typename... Args>
+    TypedTableRow(DataTableStream* table, Args&&... values)
+        : TableRow(), table_(table), values_(std::forward<Args>(values)...) {
+    }
+
+    void write(bool encoded) override {
+        std::apply(
+            [this, encoded](const auto&... values) {
+                write_table_row(table_, encoded, values...);
+            },
+            values_);
+    }
+
+  private:
+    DataTableStream* table_;
+    Row values_;
+};
+
+/* Moves the formatting, compression and output of table rows off the
+   interpreter thread. Rows are placed into a single producer single
+   consumer ring of fixed size records by the tracer and drained by a
+   dedicated writer thread. The producer and the consumer only synchronize
+   through the head and tail counters of the ring.
+
+   When the ring is full, the tracer waits for the writer thread to catch up.
+   The number of times this happens is reported as the blocked count. A
+   queue capacity of 0 disables the writer thread and rows are written
+   synchronously.
+
+   Categorical columns are written as codes if the categories are encoded.
+   This is the case for binary tables. */
+class TableWriter {
+  public:
+    TableWriter(std::size_t queue_capacity, bool encode_categories);
+
+    TableWriter(const TableWriter& other) = delete;
+
+    TableWriter& operator=(const TableWriter& other) = delete;
+
+    ~TableWriter() {
+        stop();
+    }
+
+    /* the values are checked against the schema of the table at compile
+       time. */
+    template <typename Schema, typename... Args>
+    void write_row(Table<Schema>* table, Args&&... values) {
+        check_row<Schema, Args...>();
+
+        using row_t = TypedTableRow<schema_row_t<Schema>>;
+
+        static_assert(sizeof(row_t) <= sizeof(record_t),
+                      "table row does not fit in a table writer record");
+
+        ++row_count_;
+
+        if (!is_asynchronous()) {
+            row_t(table->get_stream(), std::forward<Args>(values)...)
+                .write(encode_categories_);
+            return;
+        }
+
+        record_t* record = acquire_record_();
+        new (record->storage)
+            row_t(table->get_stream(), std::forward<Args>(values)...);
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    /* waits for the writer thread to write all queued rows and joins it.
+       rows written after this are written synchronously. */
+    void stop();
+
+    bool is_asynchronous() const {
+        return thread_.joinable();
+    }
+
+    std::size_t get_queue_capacity() const {
+        return capacity_;
+    }
+
+    std::uint64_t get_row_count() const {
+        return row_count_;
+    }
+
+    std::uint64_t get_blocked_count() const {
+        return blocked_count_;
+    }
+
+  private:
+    static const std::size_t RECORD_SIZE_ = 1024;
+    static const std::size_t CACHE_LINE_SIZE_ = 64;
+
+    struct alignas(CACHE_LINE_SIZE_) record_t {
+        unsigned char storage[RECORD_SIZE_];
+    };
+
+    record_t* acquire_record_() {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+
+            if (tail - cached_head_ == capacity_) {
+                ++blocked_count_;
+                do {
+                    std::this_thread::yield();
+                    cached_head_ = head_.load(std::memory_order_acquire);
+                } while (tail - cached_head_ == capacity_);
+            }
+        }
+
+        return &records_[tail & (capacity_ - 1)];
+    }
+
+    void run_();
+
+    std::size_t capacity_;
+    bool encode_categories_;
+    std::unique_ptr<record_t[]> records_;
+
+    /* the head is advanced by the writer thread and the tail by the tracer.
+       they live on separate cache lines to avoid false sharing. */
+    alignas(CACHE_LINE_SIZE_) std::atomic<std::size_t> head_;
+    alignas(CACHE_LINE_SIZE_) std::atomic<std::size_t> tail_;
+    std::size_t cached_head_;
+    std::uint64_t row_count_;
+    std::uint64_t blocked_count_;
+    std::atomic<bool> stopping_;
+    std::thread thread_;
+};
+
+#endif /* DYNAMISMTRACER_TABLE_WRITER_H */
@@ -1,17 +1,32 @@
 #ifndef DYNAMISMTRACER_TRACER_STATE_H
 #define DYNAMISMTRACER_TRACER_STATE_H
 
+#include "Analysis.h"
 #include "Argument.h"
 #include "Call.h"
+#include "Clock.h"
+#include "Dictionary.h"
 #include "Environment.h"
 #include "Event.h"
 #include "ExecutionContextStack.h"
 #include "Function.h"
+#include "Histogram.h"
+#include "ObjectPool.h"
+#include "Sampling.h"
+#include "SexpMap.h"
+#include "Table.h"
+#include "TableWriter.h"
 #include "Variable.h"
 #include "dynalyzer.h"
+#include "hash.h"
+#include "schemas.h"
 #include "sexptypes.h"
 #include "stdlibs.h"
 
+#include <chrono>
+#include <random>
+#include <unordered_set>
+#include <sys/resource.h>
 #include <unordered_map>
 
 class TracerState {
@@ -21,246 +36,153 @@ class TracerState {
     const bool truncate_;
     const bool binary_;
     const int compression_level_;
+    TableWriter table_writer_;
+    std::vector<bool> analyses_;
+    std::vector<bool> probes_;
+    Clock clock_;
+    const int sampling_rate_;
+    const SamplingUnit sampling_unit_;
+    const int sampling_seed_;
+    const int memory_sampling_interval_;
+    const int checkpoint_event_interval_;
+    const int checkpoint_time_interval_;
 
   public:
     TracerState(const std::string& output_dirpath,
                 bool verbose,
                 bool truncate,
                 bool binary,
-                int compression_level)
+                int compression_level,
+                int writer_queue_capacity,
+                const std::vector<Analysis>& analyses,
+                ClockType clock_type,
+                int sampling_rate,
+                SamplingUnit sampling_unit,
+                int sampling_seed,
+                int memory_sampling_interval,
+                int checkpoint_event_interval,
+                int checkpoint_time_interval)
         : output_dirpath_(output_dirpath)
         , verbose_(verbose)
         , truncate_(truncate)
         , binary_(binary)
         , compression_level_(compression_level)
+        , table_writer_(std::max(writer_queue_capacity, 0), binary)
+        , analyses_(to_underlying(Analysis::COUNT), false)
+        , probes_(to_underlying(Event::COUNT), false)
+        , clock_(clock_type)
+        , sampling_rate_(std::max(sampling_rate, 1))
+        , sampling_unit_(sampling_unit)
+        , sampling_seed_(sampling_seed)
+        , memory_sampling_interval_(std::max(memory_sampling_interval, 0))
+        , checkpoint_event_interval_(std::max(checkpoint_event_interval, 0))
+        , checkpoint_time_interval_(std::max(checkpoint_time_interval, 0))
         , environment_id_(0)
         , variable_id_(0)
+        , environment_mapping_(ENVIRONMENT_MAPPING_BUCKET_COUNT)
+        , promises_(PROMISE_MAPPING_BUCKET_COUNT)
         , denoted_value_id_counter_(0)
         , timestamp_(0)
+        , functions_(FUNCTION_MAPPING_BUCKET_SIZE)
+        , retained_functions_(nullptr)
         , call_id_counter_(0)
         , object_count_(OBJECT_TYPE_TABLE_COUNT, 0)
-        , event_counter_(to_underlying(Event::COUNT), 0) {
-        event_counts_data_table_ =
-            dynalyzer_create_data_table(output_dirpath_ + "/" + "event_counts",
-                                        {"event", "count"},
-                                        truncate_,
-                                        binary_,
-                                        compression_level_);
-
-        object_counts_data_table_ =
-            dynalyzer_create_data_table(output_dirpath_ + "/" + "object_counts",
-                                        {"type", "count"},
-                                        truncate_,
-                                        binary_,
-                                        compression_level_);
-
-        call_summaries_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "call_summaries",
-            {"function_id",
-             "package",
-             "function_name",
-             "function_type",
-             "formal_parameter_count",
-             "wrapper",
-             "S3_method",
-             "S4_method",
-             "force_order",
-             "missing_arguments",
-             "return_value_type",
-             "jumped",
-             "call_count"},
-            truncate_,
-            binary_,
-            compression_level_);
+        , event_counter_(to_underlying(Event::COUNT), 0)
+        , checkpoint_(1)
+        , checkpointed_object_count_(OBJECT_TYPE_TABLE_COUNT, 0)
+        , checkpointed_event_counter_(to_underlying(Event::COUNT), 0)
+        , probe_histograms_(to_underlying(Event::COUNT))
+        , call_pool_(OBJECT_POOL_SLAB_SIZE)
+        , argument_pool_(OBJECT_POOL_SLAB_SIZE)
+        , denoted_value_pool_(OBJECT_POOL_SLAB_SIZE)
+        , sampling_generator_(sampling_seed)
+        , environment_high_water_mark_(0)
+        , function_high_water_mark_(0)
+        , variable_high_water_mark_(0) {
+        function_cache_.reserve(FUNCTION_MAPPING_BUCKET_SIZE);
+
+        for (const Analysis analysis: analyses) {
+            analyses_[to_underlying(analysis)] = true;
+            for (const Event probe: get_required_probes(analysis)) {
+                probes_[to_underlying(probe)] = true;
+            }
+        }
 
-        dynamic_call_summaries_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "dynamic_call_summaries",
-            {"function_id",
-             "package",
-             "function_name",
-             "function_type",
-             "formal_parameter_count",
-             "S3_method",
-             "S4_method",
-             "return_value_type",
-             "call_count",
-             "dyn_call_count"},
-            truncate_,
-            binary_,
-            compression_level_);
+        event_counts_data_table_ = new Table<EventCountsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
 
-        function_definitions_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "function_definitions",
-            {"function_id",
-             "package",
-             "function_name",
-             "formal_parameter_count",
-             "byte_compiled",
-             "definition"},
-            truncate_,
-            binary_,
-            compression_level_);
+        object_counts_data_table_ = new Table<ObjectCountsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
 
-        arguments_data_table_ =
-            dynalyzer_create_data_table(output_dirpath_ + "/" + "arguments",
-                                        {"call_id",
-                                         "function_id",
-                                         "value_id",
-                                         "formal_parameter_position",
-                                         "actual_argument_position",
-                                         "argument_type",
-                                         "expression_type",
-                                         "value_type",
-                                         "default",
-                                         "dot_dot_dot",
-                                         "preforce",
-                                         "direct_force",
-                                         "direct_lookup_count",
-                                         "direct_metaprogram_count",
-                                         "indirect_force",
-                                         "indirect_lookup_count",
-                                         "indirect_metaprogram_count",
-                                         "S3_dispatch",
-                                         "S4_dispatch",
-                                         "forcing_actual_argument_position",
-                                         "non_local_return",
-                                         "execution_time",
-                                         "expression"},
-                                        truncate_,
-                                        binary_,
-                                        compression_level_);
-
-        side_effects_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "side_effects",
-            {"value_id",
-             "call_id",
-             "function_id",
-             "package",
-             "function_name",
-             "formal_parameter_position",
-             "actual_argument_position",
-             "dot_dot_dot",
-             "direct_self_scope_mutation_count",
-             "indirect_self_scope_mutation_count",
-             "direct_lexical_scope_mutation_count",
-             "indirect_lexical_scope_mutation_count",
-             "direct_non_lexical_scope_mutation_count",
-             "indirect_non_lexical_scope_mutation_count",
-             "direct_self_scope_observation_count",
-             "indirect_self_scope_observation_count",
-             "direct_lexical_scope_observation_count",
-             "indirect_lexical_scope_observation_count",
-             "direct_non_lexical_scope_observation_count",
-             "indirect_non_lexical_scope_observation_count",
-             "expression"},
-            truncate_,
-            binary_,
-            compression_level_);
+        call_summaries_data_table_ = new Table<CallSummariesSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
 
-        escaped_arguments_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "escaped_arguments",
-            {"call_id",
-             "function_id",
-             "return_value_type",
-             "formal_parameter_count",
-             "formal_parameter_position",
-             "actual_argument_position",
-             "value_id",
-             "class",
-             "S3_dispatch",
-             "S4_dispatch",
-             "argument_type",
-             "expression_type",
-             "value_type",
-             "default",
-             "non_local_return",
-             "escape",
-             "call_depth",
-             "promise_depth",
-             "nested_promise_depth",
-             "forcing_actual_argument_position",
-             "preforce",
-             "before_escape_force_count",
-             "before_escape_metaprogram_count",
-             "before_escape_value_lookup_count",
-             "before_escape_value_assign_count",
-             "before_escape_expression_lookup_count",
-             "before_escape_expression_assign_count",
-             "before_escape_environment_lookup_count",
-             "before_escape_environment_assign_count",
-             "after_escape_force_count",
-             "after_escape_metaprogram_count",
-             "after_escape_value_lookup_count",
-             "after_escape_value_assign_count",
-             "after_escape_expression_lookup_count",
-             "after_escape_expression_assign_count",
-             "after_escape_environment_lookup_count",
-             "after_escape_environment_assign_count",
-             "before_escape_direct_self_scope_mutation_count",
-             "before_escape_indirect_self_scope_mutation_count",
-             "before_escape_direct_lexical_scope_mutation_count",
-             "before_escape_indirect_lexical_scope_mutation_count",
-             "before_escape_direct_non_lexical_scope_mutation_count",
-             "before_escape_indirect_non_lexical_scope_mutation_count",
-             "before_escape_direct_self_scope_observation_count",
-             "before_escape_indirect_self_scope_observation_count",
-             "before_escape_direct_lexical_scope_observation_count",
-             "before_escape_indirect_lexical_scope_observation_count",
-             "before_escape_direct_non_lexical_scope_observation_count",
-             "before_escape_indirect_non_lexical_scope_observation_count",
-             "after_escape_direct_self_scope_mutation_count",
-             "after_escape_indirect_self_scope_mutation_count",
-             "after_escape_direct_lexical_scope_mutation_count",
-             "after_escape_indirect_lexical_scope_mutation_count",
-             "after_escape_direct_non_lexical_scope_mutation_count",
-             "after_escape_indirect_non_lexical_scope_mutation_count",
-             "after_escape_direct_self_scope_observation_count",
-             "after_escape_indirect_self_scope_observation_count",
-             "after_escape_direct_lexical_scope_observation_count",
-             "after_escape_indirect_lexical_scope_observation_count",
-             "after_escape_direct_non_lexical_scope_observation_count",
-             "after_escape_indirect_non_lexical_scope_observation_count",
-             "execution_time"},
-            truncate_,
-            binary_,
-            compression_level_);
+        dynamic_call_summaries_data_table_ =
+            new Table<DynamicCallSummariesSchema>(
+                output_dirpath_, truncate_, binary_, compression_level_);
 
-        promises_data_table_ =
-            dynalyzer_create_data_table(output_dirpath_ + "/" + "promises",
-                                        {"value_id",
-                                         "argument",
-                                         "expression_type",
-                                         "value_type",
-                                         "creation_scope",
-                                         "forcing_scope",
-                                         "S3_dispatch",
-                                         "S4_dispatch",
-                                         "preforce",
-                                         "force_count",
-                                         "call_depth",
-                                         "promise_depth",
-                                         "nested_promise_depth",
-                                         "metaprogram_count",
-                                         "value_lookup_count",
-                                         "value_assign_count",
-                                         "expression_lookup_count",
-                                         "expression_assign_count",
-                                         "environment_lookup_count",
-                                         "environment_assign_count",
-                                         "execution_time"},
-                                        truncate_,
-                                        binary_,
-                                        compression_level_);
-
-        promise_lifecycles_data_table_ = dynalyzer_create_data_table(
-            output_dirpath_ + "/" + "promise_lifecycles",
-            {"action", "count", "promise_count"},
-            truncate_,
-            binary_,
-            compression_level_);
+        function_definitions_data_table_ =
+            new Table<FunctionDefinitionsSchema>(
+                output_dirpath_, truncate_, binary_, compression_level_);
+
+        arguments_data_table_ = new Table<ArgumentsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        side_effects_data_table_ = new Table<SideEffectsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        escaped_arguments_data_table_ = new Table<EscapedArgumentsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        expressions_data_table_ = new Table<ExpressionsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        promises_data_table_ = new Table<PromisesSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        promise_lifecycles_data_table_ = new Table<PromiseLifecyclesSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        object_pools_data_table_ = new Table<ObjectPoolsSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        table_writer_data_table_ = new Table<TableWriterSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        tracer_memory_data_table_ = new Table<TracerMemorySchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        probe_overhead_data_table_ = new Table<ProbeOverheadSchema>(
+            output_dirpath_, truncate_, binary_, compression_level_);
+
+        checkpoints_data_table_ = nullptr;
+        event_count_deltas_data_table_ = nullptr;
+        object_count_deltas_data_table_ = nullptr;
+        call_summary_deltas_data_table_ = nullptr;
+        dynamic_call_summary_deltas_data_table_ = nullptr;
+        promise_lifecycle_deltas_data_table_ = nullptr;
+
+        if (is_checkpointing()) {
+            checkpoints_data_table_ = new Table<CheckpointsSchema>(
+                output_dirpath_, truncate_, binary_, compression_level_);
+            event_count_deltas_data_table_ =
+                create_deltas_table_<EventCountsSchema>();
+            object_count_deltas_data_table_ =
+                create_deltas_table_<ObjectCountsSchema>();
+            call_summary_deltas_data_table_ =
+                create_deltas_table_<CallSummariesSchema>();
+            dynamic_call_summary_deltas_data_table_ =
+                create_deltas_table_<DynamicCallSummariesSchema>();
+            promise_lifecycle_deltas_data_table_ =
+                create_deltas_table_<PromiseLifecyclesSchema>();
+        }
     }
 
     ~TracerState() {
+        /* the writer thread has to be done with the tables before they are
+           deleted. */
+        table_writer_.stop();
+
         delete event_counts_data_table_;
         delete object_counts_data_table_;
         delete call_summaries_data_table_;
@@ -270,7 +192,18 @@ class TracerState {
         delete side_effects_data_table_;
         delete promises_data_table_;
         delete escaped_arguments_data_table_;
+        delete expressions_data_table_;
         delete promise_lifecycles_data_table_;
+        delete object_pools_data_table_;
+        delete table_writer_data_table_;
+        delete probe_overhead_data_table_;
+        delete tracer_memory_data_table_;
+        delete checkpoints_data_table_;
+        delete event_count_deltas_data_table_;
+        delete object_count_deltas_data_table_;
+        delete call_summary_deltas_data_table_;
+        delete dynamic_call_summary_deltas_data_table_;
+        delete promise_lifecycle_deltas_data_table_;
     }
 
     const std::string& get_output_dirpath() const {
@@ -293,11 +226,86 @@ class TracerState {
         return compression_level_;
     }
 
-    void initialize() const {
+    bool is_enabled(const Analysis analysis) const {
+        return analyses_[to_underlying(analysis)];
+    }
+
+    /* dyntrace entry and exit are always required, they set up and tear
+     down the tracer. */
+    bool is_probe_required(const Event probe) const {
+        return probe == Event::DyntraceEntry || probe == Event::DyntraceExit ||
+               probes_[to_underlying(probe)];
+    }
+
+    std::string get_analyses_string() const {
+        std::string analyses;
+        for (int i = 0; i < to_underlying(Analysis::COUNT); ++i) {
+            if (analyses_[i]) {
+                if (!analyses.empty()) {
+                    analyses += ",";
+                }
+                analyses += to_string(static_cast<Analysis>(i));
+            }
+        }
+        return analyses;
+    }
+
+    int get_writer_queue_capacity() const {
+        return static_cast<int>(table_writer_.get_queue_capacity());
+    }
+
+    /* the summaries are checkpointed every checkpoint_event_interval_
+       events and every checkpoint_time_interval_ seconds. */
+    bool is_checkpointing() const {
+        return checkpoint_event_interval_ > 0 || checkpoint_time_interval_ > 0;
+    }
+
+    /* a tracer state with the same configuration that writes its tables to
+       another directory. the caller owns the clone. */
+    TracerState* clone(const std::string& output_dirpath) const {
+        std::vector<Analysis> analyses;
+        for (int i = 0; i < to_underlying(Analysis::COUNT); ++i) {
+            if (analyses_[i]) {
+                analyses.push_back(static_cast<Analysis>(i));
+            }
+        }
+
+        return new TracerState(output_dirpath,
+                               verbose_,
+                               truncate_,
+                               binary_,
+                               compression_level_,
+                               get_writer_queue_capacity(),
+                               analyses,
+                               clock_.get_type(),
+                               sampling_rate_,
+                               sampling_unit_,
+                               sampling_seed_,
+                               memory_sampling_interval_,
+                               checkpoint_event_interval_,
+                               checkpoint_time_interval_);
+    }
+
+    /* the event counts of a clone are added to those of this state. */
+    void add_event_counts(const TracerState& other) {
+        for (int i = 0; i < to_underlying(Event::COUNT); ++i) {
+            event_counter_[i] += other.event_counter_[i];
+        }
+    }
+
+    void initialize() {
+        clock_.calibrate();
+        /* the dyntrace entry probe is only exited. its time is measured from
+         the end of the calibration. */
+        probe_entry_time_ = clock_.now();
+        last_checkpoint_time_ = std::chrono::steady_clock::now();
         serialize_configuration_();
     }
 
     void cleanup(int error) {
+        /* the final usage is taken before the tracer state is torn down. */
+        serialize_tracer_memory_();
+
         for (auto const& binding: promises_) {
             destroy_promise(binding.second);
         }
@@ -312,11 +320,37 @@ class TracerState {
 
         function_cache_.clear();
 
-        serialize_event_counts_();
+        /* the last checkpoint makes the deltas add up to the summaries. the
+           functions destroyed above have written their deltas. */
+        if (is_checkpointing()) {
+            serialize_checkpoint_();
+        }
+
+        if (is_enabled(Analysis::EventCounts)) {
+            serialize_event_counts_();
+        }
 
         serialize_object_count_();
 
-        serialize_promise_lifecycle_summary_();
+        if (is_enabled(Analysis::Promises)) {
+            serialize_promise_lifecycle_summary_();
+        }
+
+        if (is_enabled(Analysis::ProbeOverhead)) {
+            serialize_probe_overhead_();
+        }
+
+        serialize_object_pools_();
+
+        /* all rows have to reach their tables before the NOERROR file
+           marks the output as complete. */
+        table_writer_.stop();
+
+        serialize_table_writer_();
+
+        if (is_binary()) {
+            serialize_dictionaries_();
+        }
 
         if (!get_stack_().is_empty()) {
             dyntrace_log_error("stack not empty on tracer exit.")
@@ -338,10 +372,20 @@ class TracerState {
     }
 
   private:
-    DataTableStream* event_counts_data_table_;
-    DataTableStream* object_counts_data_table_;
-    DataTableStream* promises_data_table_;
-    DataTableStream* promise_lifecycles_data_table_;
+    Table<EventCountsSchema>* event_counts_data_table_;
+    Table<ObjectCountsSchema>* object_counts_data_table_;
+    Table<PromisesSchema>* promises_data_table_;
+    Table<PromiseLifecyclesSchema>* promise_lifecycles_data_table_;
+    Table<ObjectPoolsSchema>* object_pools_data_table_;
+    Table<TableWriterSchema>* table_writer_data_table_;
+    Table<ProbeOverheadSchema>* probe_overhead_data_table_;
+    Table<TracerMemorySchema>* tracer_memory_data_table_;
+    Table<CheckpointsSchema>* checkpoints_data_table_;
+    Table<DeltasSchema<EventCountsSchema>>* event_count_deltas_data_table_;
+    Table<DeltasSchema<ObjectCountsSchema>>* object_count_deltas_data_table_;
+    Table<DeltasSchema<PromiseLifecyclesSchema>>*
+        promise_lifecycle_deltas_data_table_;
+    Dictionary promises_dictionary_;
 
     void serialize_configuration_() const {
         std::ofstream fout(get_output_dirpath() + "/CONFIGURATION",
@@ -362,22 +406,278 @@ class TracerState {
         serialize_row("binary", std::to_string(is_binary()));
         serialize_row("compression_level",
                       std::to_string(get_compression_level()));
+        serialize_row("writer_queue_capacity",
+                      std::to_string(get_writer_queue_capacity()));
+        serialize_row("analyses", get_analyses_string());
+        serialize_row("clock", to_string(clock_.get_type()));
+        if (clock_.get_type() == ClockType::Tsc) {
+            serialize_row("tsc_frequency",
+                          std::to_string(clock_.get_tsc_frequency()));
+        }
+        serialize_row("sampling_rate", std::to_string(sampling_rate_));
+        serialize_row("sampling_unit", to_string(sampling_unit_));
+        serialize_row("sampling_seed", std::to_string(sampling_seed_));
+        serialize_row("memory_sampling_interval",
+                      std::to_string(memory_sampling_interval_));
+        serialize_row("checkpoint_event_interval",
+                      std::to_string(checkpoint_event_interval_));
+        serialize_row("checkpoint_time_interval",
+                      std::to_string(checkpoint_time_interval_));
     }
 
     void serialize_event_counts_() {
         for (int i = 0; i < to_underlying(Event::COUNT); ++i) {
-            event_counts_data_table_->write_row(
+            table_writer_.write_row(
+                event_counts_data_table_,
                 to_string(static_cast<Event>(i)),
-                static_cast<double>(event_counter_[i]));
+                event_counter_[i]);
         }
     }
 
+    /* durations are in nanoseconds. */
+    void serialize_probe_overhead_() {
+        for (int i = 0; i < to_underlying(Event::COUNT); ++i) {
+            const Histogram& histogram = probe_histograms_[i];
+
+            if (histogram.get_count() == 0) {
+                continue;
+            }
+
+            table_writer_.write_row(
+                probe_overhead_data_table_,
+                to_string(static_cast<Event>(i)),
+                histogram.get_count(),
+                histogram.get_total(),
+                histogram.get_percentile(50),
+                histogram.get_percentile(90),
+                histogram.get_percentile(99),
+                histogram.get_maximum());
+        }
+    }
+
+    /* the live objects, the approximate bytes held by the tracer maps and
+     the peak resident set size. the live variables are only counted here,
+     so their high water mark is the largest count seen in a sample. */
+    void serialize_tracer_memory_() {
+        std::size_t variable_count = 0;
+        std::size_t environment_mapping_bytes =
+            environment_mapping_.get_memory_usage();
+
+        for (const auto& binding: environment_mapping_) {
+            variable_count += binding.second.get_variable_count();
+            environment_mapping_bytes += binding.second.get_memory_usage();
+        }
+
+        variable_high_water_mark_ =
+            std::max(variable_high_water_mark_, variable_count);
+
+        /* an estimate of the nodes and buckets of the unordered map and of
+         the strings owned by the functions. */
+        std::size_t function_cache_bytes =
+            function_cache_.bucket_count() * sizeof(void*);
+
+        for (const auto& binding: function_cache_) {
+            const Function* function = binding.second;
+            function_cache_bytes += sizeof(binding) + 2 * sizeof(void*) +
+                                    binding.first.capacity() +
+                                    sizeof(Function) +
+                                    function->get_definition().capacity();
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        /* linux reports the maximum resident set size in kilobytes. */
+        double max_rss_bytes = 1024.0 * usage.ru_maxrss;
+
+        table_writer_.write_row(
+            tracer_memory_data_table_,
+            timestamp_,
+            call_pool_.get_live_count(),
+            call_pool_.get_high_water_mark(),
+            argument_pool_.get_live_count(),
+            argument_pool_.get_high_water_mark(),
+            denoted_value_pool_.get_live_count(),
+            denoted_value_pool_.get_high_water_mark(),
+            function_cache_.size(),
+            function_high_water_mark_,
+            environment_mapping_.size(),
+            environment_high_water_mark_,
+            variable_count,
+            variable_high_water_mark_,
+            promises_.get_memory_usage(),
+            functions_.get_memory_usage(),
+            function_cache_bytes,
+            environment_mapping_bytes,
+            max_rss_bytes);
+    }
+
     void serialize_object_count_() {
         for (int i = 0; i < object_count_.size(); ++i) {
             if (object_count_[i] != 0) {
-                object_counts_data_table_->write_row(
+                table_writer_.write_row(
+                    object_counts_data_table_,
                     sexptype_to_string(i),
-                    static_cast<double>(object_count_[i]));
+                    object_count_[i]);
+            }
+        }
+    }
+
+    template <typename T>
+    void serialize_object_pool_(const std::string& type,
+                                const ObjectPool<T>& pool) {
+        table_writer_.write_row(
+            object_pools_data_table_,
+            type,
+            pool.get_slab_size(),
+            pool.get_slab_count(),
+            pool.get_allocation_count(),
+            pool.get_high_water_mark());
+    }
+
+    void serialize_object_pools_() {
+        serialize_object_pool_("Call", call_pool_);
+        serialize_object_pool_("Argument", argument_pool_);
+        serialize_object_pool_("DenotedValue", denoted_value_pool_);
+    }
+
+    void serialize_table_writer_() {
+        table_writer_.write_row(
+            table_writer_data_table_,
+            table_writer_.get_queue_capacity(),
+            table_writer_.get_row_count(),
+            table_writer_.get_blocked_count());
+    }
+
+    /* the codes of the categorical columns of a binary table are resolved
+       by the table named after it with a _dictionary suffix. these are
+       written once all rows are written, so they are complete. */
+    void serialize_dictionaries_() {
+        serialize_dictionary_("arguments", arguments_dictionary_);
+        serialize_dictionary_("side_effects", side_effects_dictionary_);
+        serialize_dictionary_("escaped_arguments",
+                              escaped_arguments_dictionary_);
+        serialize_dictionary_("promises", promises_dictionary_);
+        serialize_dictionary_("call_summaries", call_summaries_dictionary_);
+        serialize_dictionary_("dynamic_call_summaries",
+                              dynamic_call_summaries_dictionary_);
+
+        if (is_checkpointing()) {
+            serialize_deltas_dictionaries_();
+        }
+    }
+
+    /* the deltas tables share the dictionaries of their summary tables. the
+       dictionaries are rewritten at every checkpoint, so that the deltas of
+       an interrupted trace can be decoded. */
+    void serialize_deltas_dictionaries_() {
+        serialize_dictionary_(
+            "call_summaries_deltas", call_summaries_dictionary_, true);
+        serialize_dictionary_("dynamic_call_summaries_deltas",
+                              dynamic_call_summaries_dictionary_,
+                              true);
+    }
+
+    void serialize_dictionary_(const std::string& table_name,
+                               const Dictionary& dictionary) {
+        serialize_dictionary_(table_name, dictionary, truncate_);
+    }
+
+    void serialize_dictionary_(const std::string& table_name,
+                               const Dictionary& dictionary,
+                               bool truncate) {
+        Table<DictionarySchema> dictionary_data_table(
+            output_dirpath_,
+            table_name + "_" + DictionarySchema::NAME,
+            truncate,
+            binary_,
+            compression_level_);
+
+        for (std::size_t code = 0; code < dictionary.get_size(); ++code) {
+            dictionary_data_table.write_row(code, dictionary.get_value(code));
+        }
+    }
+
+    template <typename Schema>
+    Table<DeltasSchema<Schema>>* create_deltas_table_() const {
+        return new Table<DeltasSchema<Schema>>(
+            output_dirpath_,
+            std::string(Schema::NAME) + "_" + DeltasSchema<Schema>::NAME,
+            truncate_,
+            binary_,
+            compression_level_);
+    }
+
+    /* the clock is only read every CHECKPOINT_CLOCK_CHECK_INTERVAL events
+       to keep it off the probes. */
+    bool is_checkpoint_due_() const {
+        if (checkpoint_event_interval_ > 0 &&
+            timestamp_ % checkpoint_event_interval_ == 0) {
+            return true;
+        }
+
+        return checkpoint_time_interval_ > 0 &&
+               timestamp_ % CHECKPOINT_CLOCK_CHECK_INTERVAL == 0 &&
+               std::chrono::steady_clock::now() - last_checkpoint_time_ >=
+                   std::chrono::seconds(checkpoint_time_interval_);
+    }
+
+    /* writes the increments of the summaries since the previous checkpoint.
+       the increments of the functions released in between are written when
+       they are released, with the number of the checkpoint that follows. a
+       checkpoint is complete once it is in the checkpoints table. */
+    void serialize_checkpoint_() {
+        if (is_enabled(Analysis::EventCounts)) {
+            serialize_event_count_deltas_();
+        }
+
+        serialize_object_count_deltas_();
+
+        if (is_enabled(Analysis::Promises)) {
+            serialize_promise_lifecycle_deltas_();
+        }
+
+        for (auto const& binding: function_cache_) {
+            serialize_function_deltas_(binding.second);
+        }
+
+        table_writer_.write_row(
+            checkpoints_data_table_, checkpoint_, timestamp_);
+
+        if (is_binary()) {
+            serialize_deltas_dictionaries_();
+        }
+
+        ++checkpoint_;
+        last_checkpoint_time_ = std::chrono::steady_clock::now();
+    }
+
+    void serialize_event_count_deltas_() {
+        for (int i = 0; i < to_underlying(Event::COUNT); ++i) {
+            const unsigned long int delta =
+                event_counter_[i] - checkpointed_event_counter_[i];
+
+            if (delta != 0) {
+                table_writer_.write_row(event_count_deltas_data_table_,
+                                        checkpoint_,
+                                        to_string(static_cast<Event>(i)),
+                                        delta);
+                checkpointed_event_counter_[i] = event_counter_[i];
+            }
+        }
+    }
+
+    void serialize_object_count_deltas_() {
+        for (int i = 0; i < object_count_.size(); ++i) {
+            const unsigned int delta =
+                object_count_[i] - checkpointed_object_count_[i];
+
+            if (delta != 0) {
+                table_writer_.write_row(object_count_deltas_data_table_,
+                                        checkpoint_,
+                                        sexptype_to_string(i),
+                                        delta);
+                checkpointed_object_count_[i] = object_count_[i];
             }
         }
     }
@@ -394,9 +694,13 @@ class TracerState {
         if (iter != environment_mapping_.end()) {
             return iter->second;
         }
-        return environment_mapping_
-            .insert({rho, Environment(rho, create_next_environment_id_())})
-            .first->second;
+        Environment& environment =
+            environment_mapping_
+                .insert({rho, Environment(rho, create_next_environment_id_())})
+                .first->second;
+        environment_high_water_mark_ =
+            std::max(environment_high_water_mark_, environment_mapping_.size());
+        return environment;
     }
 
     void remove_environment(const SEXP rho) {
@@ -415,14 +719,6 @@ class TracerState {
                               const SEXP symbol,
                               bool create_environment = true,
                               bool create_variable = true) {
-        return lookup_variable(
-            rho, symbol_to_string(symbol), create_environment, create_variable);
-    }
-
-    Variable& lookup_variable(const SEXP rho,
-                              const std::string& symbol,
-                              bool create_environment = true,
-                              bool create_variable = true) {
         Environment& env = lookup_environment(rho, create_environment);
 
         bool var_exists = env.exists(symbol);
@@ -438,9 +734,8 @@ class TracerState {
     Variable& define_variable(const SEXP rho,
                               const SEXP symbol,
                               bool create_environment = true) {
-        return lookup_environment(rho, true).define(symbol_to_string(symbol),
-                                                    create_next_variable_id_(),
-                                                    get_current_timestamp_());
+        return lookup_environment(rho, true).define(
+            symbol, create_next_variable_id_(), get_current_timestamp_());
     }
 
     Variable& update_variable(const SEXP rho,
@@ -455,8 +750,7 @@ class TracerState {
     Variable remove_variable(const SEXP rho,
                              const SEXP symbol,
                              bool create_environment = true) {
-        return lookup_environment(rho, create_environment)
-            .remove(symbol_to_string(symbol));
+        return lookup_environment(rho, create_environment).remove(symbol);
     }
 
   private:
@@ -470,19 +764,20 @@ class TracerState {
 
     env_id_t environment_id_;
     var_id_t variable_id_;
-    std::unordered_map<SEXP, Environment> environment_mapping_;
+    SexpMap<Environment> environment_mapping_;
 
   public:
     void resume_execution_timer() {
-        execution_resume_time_ = std::chrono::high_resolution_clock::now();
+        execution_resume_time_ = clock_.now();
     }
 
     void pause_execution_timer() {
-        auto execution_pause_time = std::chrono::high_resolution_clock::now();
+        if (clock_.is_off()) {
+            return;
+        }
+        probe_entry_time_ = clock_.now();
         std::uint64_t execution_time =
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                execution_pause_time - execution_resume_time_)
-                .count();
+            clock_.to_nanoseconds(probe_entry_time_ - execution_resume_time_);
         ExecutionContextStack& stack(get_stack_());
         if (!stack.is_empty()) {
             stack.peek(1).increment_execution_time(execution_time);
@@ -504,13 +799,22 @@ class TracerState {
         get_stack_().push(context);
     }
 
+    void push_stack(Function* function,
+                    const char* function_name,
+                    const SEXP rho,
+                    const dyntrace_dispatch_t dispatch) {
+        get_stack_().push(function, function_name, rho, dispatch);
+    }
+
     execution_contexts_t unwind_stack(const RCNTXT* context) {
         return get_stack_().unwind(ExecutionContext(context));
     }
 
   private:
-    std::chrono::time_point<std::chrono::high_resolution_clock>
-        execution_resume_time_;
+    std::uint64_t execution_resume_time_;
+    /* the clock reading at the start of the current probe. the probe body
+     is timed with the readings the execution timer takes anyway. */
+    std::uint64_t probe_entry_time_;
 
     /***************************************************************************
      * PROMISE
@@ -562,6 +866,18 @@ class TracerState {
         return iter->second;
     }
 
+    void remove_promise(const SEXP promise) {
+        auto iter = promises_.find(promise);
+
+        /* promises not reachable from any traced call never make it to the
+         map. There is nothing to release for them. */
+        if (iter != promises_.end()) {
+            DenotedValue* promise_state = iter->second;
+            promises_.erase(iter);
+            destroy_promise(promise_state);
+        }
+    }
+
     void remove_promise(const SEXP promise, DenotedValue* promise_state) {
         promises_.erase(promise);
         destroy_promise(promise_state);
@@ -581,16 +897,18 @@ class TracerState {
          and when that call gets deleted, it will delete this promise */
         promise_state->set_inactive();
 
-        serialize_promise_(promise_state);
+        if (is_enabled(Analysis::Promises)) {
+            serialize_promise_(promise_state);
 
-        summarize_promise_lifecycle_(promise_state->get_lifecycle());
+            summarize_promise_lifecycle_(promise_state->get_lifecycle());
 
-        if (promise_state->has_escaped()) {
-            serialize_escaped_promise_(promise_state);
+            if (promise_state->has_escaped()) {
+                serialize_escaped_promise_(promise_state);
+            }
         }
 
         if (!promise_state->is_argument()) {
-            delete promise_state;
+            denoted_value_pool_.deallocate(promise_state);
         }
     }
 
@@ -600,11 +918,13 @@ class TracerState {
     }
 
     void serialize_promise_(DenotedValue* promise) {
-        promises_data_table_->write_row(
+        table_writer_.write_row(
+            promises_data_table_,
             promise->get_id(),
             promise->was_argument(),
-            sexptype_to_string(promise->get_expression_type()),
-            sexptype_to_string(promise->get_value_type()),
+            promises_dictionary_.encode_sexptype(
+                promise->get_expression_type()),
+            promises_dictionary_.encode_sexptype(promise->get_value_type()),
             promise->get_creation_scope(),
             promise->get_forcing_scope(),
             promise->get_S3_dispatch_count(),
@@ -625,10 +945,12 @@ class TracerState {
     }
 
     void serialize_escaped_promise_(DenotedValue* promise) {
-        escaped_arguments_data_table_->write_row(
+        table_writer_.write_row(
+            escaped_arguments_data_table_,
             promise->get_previous_call_id(),
             promise->get_previous_function_id(),
-            sexptype_to_string(promise->get_previous_call_return_value_type()),
+            escaped_arguments_dictionary_.encode_sexptype(
+                promise->get_previous_call_return_value_type()),
             promise->get_previous_formal_parameter_count(),
             promise->get_previous_formal_parameter_position(),
             promise->get_previous_actual_argument_position(),
@@ -636,9 +958,11 @@ class TracerState {
             promise->get_class_name(),
             promise->get_S3_dispatch_count(),
             promise->get_S4_dispatch_count(),
-            sexptype_to_string(promise->get_type()),
-            sexptype_to_string(promise->get_expression_type()),
-            sexptype_to_string(promise->get_value_type()),
+            escaped_arguments_dictionary_.encode_sexptype(promise->get_type()),
+            escaped_arguments_dictionary_.encode_sexptype(
+                promise->get_expression_type()),
+            escaped_arguments_dictionary_.encode_sexptype(
+                promise->get_value_type()),
             promise->get_previous_default_argument(),
             promise->does_non_local_return(),
             promise->has_escaped(),
@@ -696,8 +1020,8 @@ class TracerState {
     DenotedValue* create_raw_promise_(const SEXP promise, bool local) {
         dyntrace_get_promise_environment(promise);
 
-        DenotedValue* promise_state =
-            new DenotedValue(get_next_denoted_value_id_(), promise, local);
+        DenotedValue* promise_state = denoted_value_pool_.allocate(
+            get_next_denoted_value_id_(), promise, local);
 
         promise_state->set_creation_scope(infer_creation_scope());
 
@@ -708,7 +1032,7 @@ class TracerState {
         return promise_state;
     }
 
-    std::unordered_map<SEXP, DenotedValue*> promises_;
+    SexpMap<DenotedValue*> promises_;
     denoted_value_id_t denoted_value_id_counter_;
 
   private:
@@ -723,63 +1047,113 @@ class TracerState {
     timestamp_t timestamp_;
 
   public:
-    scope_t infer_creation_scope() {
-        ExecutionContextStack& stack = get_stack_();
-
-        for (auto iter = stack.crbegin(); iter != stack.crend(); ++iter) {
-            if (iter->is_call()) {
-                const Function* const function =
-                    iter->get_call()->get_function();
-                /* '{' function as promise creation source is not very
-                 insightful. We want to keep going back until we find
-                 something meaningful. */
-                if (!function->is_curly_bracket()) {
-                    return function->get_id();
-                }
-            }
-        }
-        return TOP_LEVEL_SCOPE;
+    /* the id of the function of the nearest call frame that is not a '{'
+     call. the frames are annotated with it when they are pushed. */
+    const scope_t& infer_creation_scope() const {
+        const Function* function = stack_.get_creation_scope_function();
+        return function == nullptr ? TOP_LEVEL_SCOPE : function->get_id();
     }
 
-    scope_t infer_forcing_scope() {
-        const ExecutionContextStack& stack = get_stack_();
-
-        for (auto iter = stack.crbegin(); iter != stack.crend(); ++iter) {
-            const ExecutionContext& exec_ctxt = *iter;
+    void exit_probe(const Event event) {
+        resume_execution_timer();
 
-            if (exec_ctxt.is_r_context()) {
-                continue;
-            } else if (exec_ctxt.is_promise()) {
-                return "Promise";
-            } else {
-                return exec_ctxt.get_call()->get_function_name();
-            }
+        if (is_enabled(Analysis::ProbeOverhead) && !clock_.is_off()) {
+            probe_histograms_[to_underlying(event)].record(
+                clock_.to_nanoseconds(execution_resume_time_ -
+                                      probe_entry_time_));
         }
-
-        return TOP_LEVEL_SCOPE;
     }
 
-    void exit_probe(const Event event) {
-        resume_execution_timer();
+    /* counts an event without touching the execution timer or the
+     timestamp. used by probes that only feed the event counts. */
+    void count_event(const Event event, unsigned long int count = 1) {
+        event_counter_[to_underlying(event)] += count;
     }
 
     void enter_probe(const Event event) {
         pause_execution_timer();
         increment_timestamp_();
         ++event_counter_[to_underlying(event)];
+
+        if (memory_sampling_interval_ > 0 &&
+            timestamp_ % memory_sampling_interval_ == 0) {
+            serialize_tracer_memory_();
+            restart_probe_timer_();
+        }
+
+        if (is_checkpoint_due_()) {
+            serialize_checkpoint_();
+            restart_probe_timer_();
+        }
+    }
+
+    /* the samples taken on probe entry are not part of the probe overhead.
+     the probe is timed from the end of the sample. */
+    void restart_probe_timer_() {
+        if (!clock_.is_off()) {
+            probe_entry_time_ = clock_.now();
+        }
     }
 
   public:
+    /* builtin and special calls are traced with compact stack frames unless
+     they need a Call object. '<<-' calls are inspected for dynamic function
+     definitions and '{' calls are notified of their callees for wrapper
+     analysis. */
+    bool needs_call(const Function* function) const {
+        return function->is_closure() || function->is_super_assign() ||
+               function->is_curly_bracket();
+    }
+
+    /* decides if a closure call is traced in full. with a sampling rate of
+     N, every Nth call of each function or call site is sampled. the position
+     of the first sampled call is drawn from the seeded generator, so that
+     functions called in lockstep are not sampled in lockstep, while runs
+     with the same seed sample the same calls. */
+    bool sample_call(Function* function, const SEXP call) {
+        if (sampling_rate_ == 1) {
+            return true;
+        }
+
+        int* countdown = nullptr;
+
+        if (sampling_unit_ == SamplingUnit::Function) {
+            countdown = &function->get_sampling_countdown();
+        } else {
+            countdown = &call_site_countdowns_.insert({call, -1}).first->second;
+        }
+
+        if (*countdown < 0) {
+            *countdown = std::uniform_int_distribution<int>(
+                0, sampling_rate_ - 1)(sampling_generator_);
+        }
+
+        if (*countdown == 0) {
+            *countdown = sampling_rate_ - 1;
+            return true;
+        }
+
+        --*countdown;
+        return false;
+    }
+
+    void remove_call_site(const SEXP call) {
+        if (sampling_unit_ == SamplingUnit::CallSite) {
+            call_site_countdowns_.erase(call);
+        }
+    }
+
     Call* create_call(const SEXP call,
                       const SEXP op,
+                      Function* function,
                       const SEXP args,
                       const SEXP rho) {
-        Function* function = lookup_function(op);
         Call* function_call = nullptr;
         call_id_t call_id = get_next_call_id_();
-        const std::string function_name = get_name(call);
+        const char* function_name = get_name(call);
 
-        function_call = new Call(call_id, function_name, rho, function, args);
+        function_call = call_pool_.allocate(
+            call_id, function_name, rho, function, args);
 
         if (TYPEOF(op) == CLOSXP) {
             process_closure_arguments_(function_call, op);
@@ -790,18 +1164,43 @@ class TracerState {
         return function_call;
     }
 
+    /* creates a call from the information logged in record mode. the
+     arguments are not logged, only the positions of the missing ones. */
+    Call* create_call(Function* function,
+                      const char* function_name,
+                      const pos_seq_t& missing_argument_positions) {
+        Call* function_call = call_pool_.allocate(
+            get_next_call_id_(), function_name, nullptr, function, nullptr);
+
+        if (function->is_closure()) {
+            function_call->set_missing_argument_positions(
+                missing_argument_positions);
+        } else {
+            function_call->set_force_order(
+                function->get_primitive_force_order()[0]);
+        }
+
+        return function_call;
+    }
+
     void destroy_call(Call* call) {
         Function* function = call->get_function();
 
-        function->add_summary(call);
+        /* a sampled closure call stands for sampling rate calls. primitive
+         calls are not sampled. its arguments are weighted alike. */
+        const int weight = function->is_closure() ? sampling_rate_ : 1;
+
+        function->add_summary(call, weight);
 
         for (Argument* argument: call->get_arguments()) {
-            serialize_argument_(argument);
+            if (is_enabled(Analysis::Arguments)) {
+                serialize_argument_(argument, weight);
+            }
 
             DenotedValue* value = argument->get_denoted_value();
 
             if (!value->is_active()) {
-                delete value;
+                denoted_value_pool_.deallocate(value);
             } else {
                 value->remove_argument(
                     call->get_id(),
@@ -813,10 +1212,32 @@ class TracerState {
 
             argument->set_denoted_value(nullptr);
 
-            delete argument;
+            argument_pool_.deallocate(argument);
+        }
+
+        call_pool_.deallocate(call);
+    }
+
+    void destroy_compact_call(const ExecutionContext& exec_ctxt,
+                              sexptype_t return_value_type,
+                              bool jumped) {
+        Function* function = exec_ctxt.get_function();
+
+        /* closure calls that were not sampled are not summarized. the sampled
+         calls account for them. as nothing is known about their callees,
+         they are conservatively reported as non wrappers to their caller. */
+        if (function->is_closure()) {
+            notify_caller(false);
+            return;
         }
 
-        delete call;
+        notify_caller(function->is_native_interface());
+
+        function->add_summary(exec_ctxt.get_function_name(),
+                              return_value_type,
+                              jumped,
+                              exec_ctxt.is_S3_method(),
+                              exec_ctxt.is_S4_method());
     }
 
   private:
@@ -835,8 +1256,8 @@ class TracerState {
         if (type_of_sexp(argument) == PROMSXP) {
             value = lookup_promise(argument, true);
         } else {
-            value =
-                new DenotedValue(get_next_denoted_value_id_(), argument, false);
+            value = denoted_value_pool_.allocate(
+                get_next_denoted_value_id_(), argument, false);
             value->set_creation_scope(infer_creation_scope());
         }
 
@@ -847,11 +1268,11 @@ class TracerState {
                 call->get_environment() == value->get_environment();
         }
 
-        Argument* arg = new Argument(call,
-                                     formal_parameter_position,
-                                     actual_argument_position,
-                                     default_argument,
-                                     dot_dot_dot);
+        Argument* arg = argument_pool_.allocate(call,
+                                                formal_parameter_position,
+                                                actual_argument_position,
+                                                default_argument,
+                                                dot_dot_dot);
         arg->set_denoted_value(value);
 
         value->add_argument(arg);
@@ -908,20 +1329,26 @@ class TracerState {
         }
     }
 
-    void serialize_argument_(Argument* argument) {
+    void serialize_argument_(Argument* argument, int weight) {
         Call* call = argument->get_call();
         Function* function = call->get_function();
         DenotedValue* value = argument->get_denoted_value();
 
-        arguments_data_table_->write_row(
+        const int expression_id = value->is_promise()
+                                      ? intern_promise_expression_(value)
+                                      : UNASSIGNED_EXPRESSION_ID;
+
+        table_writer_.write_row(
+            arguments_data_table_,
             call->get_id(),
             function->get_id(),
             value->get_id(),
             argument->get_formal_parameter_position(),
             argument->get_actual_argument_position(),
-            sexptype_to_string(value->get_type()),
-            sexptype_to_string(value->get_expression_type()),
-            sexptype_to_string(value->get_value_type()),
+            arguments_dictionary_.encode_sexptype(value->get_type()),
+            arguments_dictionary_.encode_sexptype(
+                value->get_expression_type()),
+            arguments_dictionary_.encode_sexptype(value->get_value_type()),
             argument->is_default_argument(),
             argument->is_dot_dot_dot(),
             value->is_preforced(),
@@ -936,15 +1363,17 @@ class TracerState {
             argument->get_forcing_actual_argument_position(),
             argument->does_non_local_return(),
             value->get_execution_time(),
-            value->get_serialized_expression());
+            expression_id,
+            weight);
 
-        if (value->is_promise() && value->get_serialized_expression() != "") {
-            side_effects_data_table_->write_row(
+        if (value->is_promise() && value->has_side_effects()) {
+            table_writer_.write_row(
+                side_effects_data_table_,
                 value->get_id(),
                 call->get_id(),
                 function->get_id(),
-                function->get_namespace(),
-                function->get_name_string(),
+                side_effects_dictionary_.encode(function->get_namespace()),
+                function->encode_name_string(side_effects_dictionary_),
                 argument->get_formal_parameter_position(),
                 argument->get_actual_argument_position(),
                 argument->is_dot_dot_dot(),
@@ -960,19 +1389,29 @@ class TracerState {
                 value->get_lexical_scope_observation_count(false),
                 value->get_non_lexical_scope_observation_count(true),
                 value->get_non_lexical_scope_observation_count(false),
-                value->get_serialized_expression());
+                expression_id,
+                weight);
         }
     }
 
-    DataTableStream* arguments_data_table_;
-    DataTableStream* side_effects_data_table_;
-    DataTableStream* escaped_arguments_data_table_;
+    Table<ArgumentsSchema>* arguments_data_table_;
+    Table<SideEffectsSchema>* side_effects_data_table_;
+    Table<EscapedArgumentsSchema>* escaped_arguments_data_table_;
+    Table<ExpressionsSchema>* expressions_data_table_;
+    /* the ids of the expressions already in the expressions table, by the
+       hash of the expression. */
+    std::unordered_map<hash128_t, int, hash128_hash> expression_ids_;
+    Dictionary arguments_dictionary_;
+    Dictionary side_effects_dictionary_;
+    Dictionary escaped_arguments_dictionary_;
 
     /***************************************************************************
      * Function API
      ***************************************************************************/
   public:
-    Function* lookup_function(const SEXP op) {
+    /* function_name is the name the function is called by. it is the first
+     name of new function states. */
+    Function* lookup_function(const SEXP op, const char* function_name) {
         Function* function = nullptr;
 
         auto iter = functions_.find(op);
@@ -981,28 +1420,87 @@ class TracerState {
             return iter->second;
         }
 
-        const auto [package_name, function_definition, function_id] =
-            Function::compute_definition_and_id(op);
+        const auto [package_name, function_id] =
+            Function::compute_namespace_and_id(op);
+
+        function = lookup_cached_function(function_id);
 
-        auto iter2 = function_cache_.find(function_id);
+        /* closures are deparsed only when their id is seen for the first
+         time and their definitions are written. closure factories create
+         many closures that share an id. */
+        if (function == nullptr) {
+            const bool defined =
+                !is_enabled(Analysis::FunctionDefinitions) ||
+                defined_function_ids_.count(function_id) != 0;
 
-        if (iter2 == function_cache_.end()) {
             function = new Function(
-                op, package_name, function_definition, function_id);
-            function_cache_.insert({function_id, function});
-        } else {
-            function = iter2->second;
+                op,
+                package_name,
+                defined ? "" : Function::compute_definition(op),
+                function_id);
+            function->add_name(function_name);
+            cache_function(function);
         }
 
         functions_.insert({op, function});
+        function->add_reference();
         return function;
     }
 
+    /* the live function state with this id, nullptr if there is none. */
+    Function* lookup_cached_function(const function_id_t& function_id) {
+        auto iter = function_cache_.find(function_id);
+        return iter == function_cache_.end() ? nullptr : iter->second;
+    }
+
+    /* the function states are handed over to functions instead of being
+       serialized and freed, so that they can be merged with the states of
+       other traces. */
+    void retain_functions(std::vector<Function*>& functions) {
+        retained_functions_ = &functions;
+    }
+
+    /* the definition of a function is written the first time its id is
+     cached. it is dropped afterwards, so that only the summaries stay in
+     memory, unless the function is retained for a merge that needs it. */
+    void cache_function(Function* function) {
+        function_cache_.insert({function->get_id(), function});
+        function_high_water_mark_ =
+            std::max(function_high_water_mark_, function_cache_.size());
+
+        if (is_enabled(Analysis::FunctionDefinitions) &&
+            defined_function_ids_.insert(function->get_id()).second) {
+            serialize_function_definition_(function);
+        }
+
+        if (retained_functions_ == nullptr) {
+            function->drop_definition();
+        }
+    }
+
     void remove_function(const SEXP op) {
         auto it = functions_.find(op);
 
-        if (it != functions_.end()) {
-            functions_.erase(it);
+        if (it == functions_.end()) {
+            return;
+        }
+
+        Function* function = it->second;
+
+        functions_.erase(it);
+
+        release_function(function);
+    }
+
+    /* many closure objects share the same function state if their
+     definitions are identical. The state is serialized and freed only
+     when the last of these closures is reclaimed. If an identical
+     closure is created later, it gets a fresh function state whose
+     summaries are serialized with the same function id. */
+    void release_function(Function* function) {
+        if (function->remove_reference() == 0) {
+            function_cache_.erase(function->get_id());
+            destroy_function_(function);
         }
     }
 
@@ -1010,8 +1508,7 @@ class TracerState {
                                  SEXP param,
                                  Call* fn_call) {
         if (expression_type == LANGSXP) {
-            std::string sym_name = CHAR(PRINTNAME(CAR(param)));
-            if (sym_name.compare("function") == 0) {
+            if (is_function_definition(param)) {
                 fn_call->set_dynamic_call();
             }
         } else if (expression_type == SYMSXP) {
@@ -1048,38 +1545,60 @@ class TracerState {
 
   private:
     void destroy_function_(Function* function) {
+        if (retained_functions_ != nullptr) {
+            retained_functions_->push_back(function);
+            return;
+        }
+
+        if (is_checkpointing()) {
+            serialize_function_deltas_(function);
+        }
+
         serialize_function_(function);
         delete function;
     }
 
-    DataTableStream* call_summaries_data_table_;
-    DataTableStream* dynamic_call_summaries_data_table_;
-    DataTableStream* function_definitions_data_table_;
-    std::unordered_map<SEXP, Function*> functions_;
+    Table<CallSummariesSchema>* call_summaries_data_table_;
+    Table<DynamicCallSummariesSchema>* dynamic_call_summaries_data_table_;
+    Table<FunctionDefinitionsSchema>* function_definitions_data_table_;
+    Table<DeltasSchema<CallSummariesSchema>>* call_summary_deltas_data_table_;
+    Table<DeltasSchema<DynamicCallSummariesSchema>>*
+        dynamic_call_summary_deltas_data_table_;
+    Dictionary call_summaries_dictionary_;
+    Dictionary dynamic_call_summaries_dictionary_;
+    SexpMap<Function*> functions_;
     std::unordered_map<function_id_t, Function*> function_cache_;
+    /* the ids of the functions whose definitions are written. */
+    std::unordered_set<function_id_t> defined_function_ids_;
+    std::vector<Function*>* retained_functions_;
 
     void serialize_function_(Function* function) {
-        const std::string all_names = function->get_name_string();
-        serialize_function_call_summary_(function, all_names);
-        serialize_function_definition_(function, all_names);
-        serialize_dynamic_call_summary_(function, all_names);
+        if (is_enabled(Analysis::CallSummaries)) {
+            const std::string all_names = function->get_name_string();
+            serialize_function_call_summary_(function, all_names);
+            serialize_dynamic_call_summary_(function, all_names);
+        }
     }
 
     void serialize_dynamic_call_summary_(const Function* function,
                                          const std::string& names) {
+        Dictionary& dictionary = dynamic_call_summaries_dictionary_;
+
         for (std::size_t i = 0; i < function->get_summary_count(); ++i) {
             const CallSummary& call_summary = function->get_call_summary(i);
 
             if (call_summary.get_dynamic_call_count() > 0) {
-                dynamic_call_summaries_data_table_->write_row(
+                table_writer_.write_row(
+                    dynamic_call_summaries_data_table_,
                     function->get_id(),
                     function->get_namespace(),
                     names,
-                    sexptype_to_string(function->get_type()),
+                    dictionary.encode_sexptype(function->get_type()),
                     function->get_formal_parameter_count(),
                     call_summary.is_S3_method(),
                     call_summary.is_S4_method(),
-                    sexptype_to_string(call_summary.get_return_value_type()),
+                    dictionary.encode_sexptype(
+                        call_summary.get_return_value_type()),
                     call_summary.get_call_count(),
                     call_summary.get_dynamic_call_count());
             }
@@ -1088,14 +1607,23 @@ class TracerState {
 
     void serialize_function_call_summary_(const Function* function,
                                           const std::string& names) {
+        /* the columns that are the same for all summaries of the function
+           are encoded once. */
+        const Category package =
+            call_summaries_dictionary_.encode(function->get_namespace());
+        const Category function_name = call_summaries_dictionary_.encode(names);
+        const Category function_type =
+            call_summaries_dictionary_.encode_sexptype(function->get_type());
+
         for (std::size_t i = 0; i < function->get_summary_count(); ++i) {
             const CallSummary& call_summary = function->get_call_summary(i);
 
-            call_summaries_data_table_->write_row(
+            table_writer_.write_row(
+                call_summaries_data_table_,
                 function->get_id(),
-                function->get_namespace(),
-                names,
-                sexptype_to_string(function->get_type()),
+                package,
+                function_name,
+                function_type,
                 function->get_formal_parameter_count(),
                 function->is_wrapper(),
                 call_summary.is_S3_method(),
@@ -1103,18 +1631,89 @@ class TracerState {
                 pos_seq_to_string(call_summary.get_force_order()),
                 pos_seq_to_string(
                     call_summary.get_missing_argument_positions()),
-                sexptype_to_string(call_summary.get_return_value_type()),
+                call_summaries_dictionary_.encode_sexptype(
+                    call_summary.get_return_value_type()),
                 call_summary.is_jumped(),
                 call_summary.get_call_count());
         }
     }
 
-    void serialize_function_definition_(const Function* function,
-                                        const std::string& names) {
-        function_definitions_data_table_->write_row(
+    /* the call counts of a function since the previous checkpoint. */
+    void serialize_function_deltas_(Function* function) {
+        if (!is_enabled(Analysis::CallSummaries) ||
+            !has_call_count_deltas_(function)) {
+            return;
+        }
+
+        const std::string names = function->get_name_string();
+        const Category package =
+            call_summaries_dictionary_.encode(function->get_namespace());
+        const Category function_name = call_summaries_dictionary_.encode(names);
+        const Category function_type =
+            call_summaries_dictionary_.encode_sexptype(function->get_type());
+        Dictionary& dictionary = dynamic_call_summaries_dictionary_;
+
+        for (std::size_t i = 0; i < function->get_summary_count(); ++i) {
+            CallSummary& call_summary = function->get_call_summary(i);
+
+            if (call_summary.get_call_count_delta() > 0) {
+                table_writer_.write_row(
+                    call_summary_deltas_data_table_,
+                    checkpoint_,
+                    function->get_id(),
+                    package,
+                    function_name,
+                    function_type,
+                    function->get_formal_parameter_count(),
+                    function->is_wrapper(),
+                    call_summary.is_S3_method(),
+                    call_summary.is_S4_method(),
+                    pos_seq_to_string(call_summary.get_force_order()),
+                    pos_seq_to_string(
+                        call_summary.get_missing_argument_positions()),
+                    call_summaries_dictionary_.encode_sexptype(
+                        call_summary.get_return_value_type()),
+                    call_summary.is_jumped(),
+                    call_summary.get_call_count_delta());
+            }
+
+            if (call_summary.get_dynamic_call_count() > 0 &&
+                call_summary.get_dynamic_summary_call_count_delta() > 0) {
+                table_writer_.write_row(
+                    dynamic_call_summary_deltas_data_table_,
+                    checkpoint_,
+                    function->get_id(),
+                    function->get_namespace(),
+                    names,
+                    dictionary.encode_sexptype(function->get_type()),
+                    function->get_formal_parameter_count(),
+                    call_summary.is_S3_method(),
+                    call_summary.is_S4_method(),
+                    dictionary.encode_sexptype(
+                        call_summary.get_return_value_type()),
+                    call_summary.get_dynamic_summary_call_count_delta(),
+                    call_summary.get_dynamic_call_count_delta());
+            }
+
+            call_summary.checkpoint();
+        }
+    }
+
+    bool has_call_count_deltas_(const Function* function) const {
+        for (std::size_t i = 0; i < function->get_summary_count(); ++i) {
+            if (function->get_call_summary(i).get_call_count_delta() > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void serialize_function_definition_(const Function* function) {
+        table_writer_.write_row(
+            function_definitions_data_table_,
             function->get_id(),
             function->get_namespace(),
-            names,
+            function->get_name_string(),
             function->get_formal_parameter_count(),
             function->is_byte_compiled(),
             function->get_definition());
@@ -1122,58 +1721,33 @@ class TracerState {
 
   public:
     void identify_side_effect_creators(const Variable& var, const SEXP env) {
-        bool direct = true;
-        ExecutionContextStack& stack = get_stack_();
+        DenotedValue* promise = find_side_effect_promise_(env);
 
-        for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter) {
-            ExecutionContext& exec_ctxt = *iter;
+        if (promise == nullptr) {
+            return;
+        }
 
-            if (exec_ctxt.is_closure()) {
-                if (exec_ctxt.get_closure()->get_environment() == env) {
-                    /* its normal for a function to mutate variables in its
-                     own environment. this case is not interesting. */
-                    return;
-                }
-            }
+        const SEXP prom_env = promise->get_environment();
 
-            if (exec_ctxt.is_promise()) {
-                DenotedValue* promise = exec_ctxt.get_promise();
+        const timestamp_t var_timestamp = var.get_modification_timestamp();
 
-                const SEXP prom_env = promise->get_environment();
-
-                const timestamp_t var_timestamp =
-                    var.get_modification_timestamp();
-
-                if (prom_env == env) {
-                    if (promise->get_creation_timestamp() > var_timestamp) {
-                        promise->set_self_scope_mutation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        return;
-                    }
-                } else if (is_parent_environment(env, prom_env)) {
-                    if (promise->get_creation_timestamp() > var_timestamp) {
-                        /* if this happens, promise is causing side effect
-                         in its lexically scoped environment. */
-                        promise->set_lexical_scope_mutation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        return;
-                    }
-                } else {
-                    if (promise->get_creation_timestamp() > var_timestamp) {
-                        /* if this happens, promise is causing side effect
-                         in non lexically scoped environment */
-                        promise->set_non_lexical_scope_mutation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        return;
-                    }
-                }
-            }
+        /* the promise only causes the side effect if it was created after
+         the variable was last modified. only the innermost promise is
+         considered, so the side effect is always direct. */
+        if (promise->get_creation_timestamp() <= var_timestamp) {
+            return;
+        }
+
+        if (prom_env == env) {
+            promise->set_self_scope_mutation(true);
+        } else if (is_parent_environment(env, prom_env)) {
+            /* if this happens, promise is causing side effect
+             in its lexically scoped environment. */
+            promise->set_lexical_scope_mutation(true);
+        } else {
+            /* if this happens, promise is causing side effect
+             in non lexically scoped environment */
+            promise->set_non_lexical_scope_mutation(true);
         }
     }
 
@@ -1187,88 +1761,110 @@ class TracerState {
             return;
         }
 
+        DenotedValue* promise = find_side_effect_promise_(env);
+
+        if (promise == nullptr) {
+            return;
+        }
+
+        const SEXP prom_env = promise->get_environment();
+
         /* if the modification timestamp of the variable is
          greater than the creation timestamp of the promise,
-         then, that promise has identified a side effect */
+         then, that promise has identified a side effect. return
+         if the promise observes a variable created before it. */
+        if (promise->get_creation_timestamp() >= var_timestamp) {
+            return;
+        }
 
-        bool direct = true;
+        if (prom_env == env) {
+            promise->set_self_scope_observation(true);
+        } else if (is_parent_environment(env, prom_env)) {
+            /* if this happens, promise is observing side effect
+             in its lexically scoped environment. */
+            promise->set_lexical_scope_observation(true);
+        } else {
+            /* if this happens, promise is observing side effect
+             in non lexically scoped environment */
+            promise->set_non_lexical_scope_observation(true);
+        }
+    }
 
-        ExecutionContextStack& stack = get_stack_();
+  private:
+    /* the expression is hashed structurally, which is much cheaper than
+     deparsing it. it is only deparsed and written the first time its hash
+     is seen, so repeated expressions like x or list(...) are stored once.
+     the whole 128 bit hash is compared, so only a collision of both words
+     merges two expressions. a promise passed on to other calls keeps its
+     id. */
+    int intern_promise_expression_(DenotedValue* promise) {
+        if (promise->has_expression_id()) {
+            return promise->get_expression_id();
+        }
 
-        for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter) {
-            ExecutionContext& exec_ctxt = *iter;
+        const SEXP expression = promise->get_expression();
 
-            /* If the most recent context that is responsible for this
-             side effect is a closure, then return. Currently, we only
-             care about promises directly responsible for side effects.
-             We don't return in case of specials and builtins because
-             they are more like operators in a programming language and
-             everything ultimately happens in them and returning on
-             encountering them will make it look like no promise has
-             caused a side effect. */
+        Hasher hasher;
+        hash_sexp(hasher, expression);
 
-            if (exec_ctxt.is_closure()) {
-                if (exec_ctxt.get_closure()->get_environment() == env) {
-                    /* its normal for a function to mutate variables in its
-                     own environment. this case is not interesting. */
-                    return;
-                }
-            }
+        auto result = expression_ids_.insert(
+            {hasher.digest(), static_cast<int>(expression_ids_.size())});
+        const int expression_id = result.first->second;
 
-            if (exec_ctxt.is_promise()) {
-                DenotedValue* promise = exec_ctxt.get_promise();
+        if (result.second) {
+            table_writer_.write_row(expressions_data_table_,
+                                    expression_id,
+                                    serialize_r_expression(expression));
+        }
 
-                const SEXP prom_env = promise->get_environment();
-
-                if (prom_env == env) {
-                    if (promise->get_creation_timestamp() < var_timestamp) {
-                        promise->set_self_scope_observation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        /* return if the promise observes a variable in its
-                         * environment created before it. */
-                        return;
-                    }
-                } else if (is_parent_environment(env, prom_env)) {
-                    /* if this happens, promise is observing side effect
-                     in its lexically scoped environment. */
-                    if (promise->get_creation_timestamp() < var_timestamp) {
-                        promise->set_lexical_scope_observation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        return;
-                    }
-                } else {
-                    /* if this happens, promise is observing side effect
-                     in non lexically scoped environment */
-                    if (promise->get_creation_timestamp() < var_timestamp) {
-                        promise->set_non_lexical_scope_observation(direct);
-                        direct = false;
-                        return; // to remove
-                    } else {
-                        return;
-                    }
-                }
-            }
+        promise->set_expression_id(expression_id);
+
+        return expression_id;
+    }
+
+    /* the promise held responsible for a side effect on a variable of env.
+     this is the innermost promise being forced, unless a closure running in
+     env was called after it. its normal for a function to mutate variables
+     in its own environment, so this case is not interesting. builtins and
+     specials do not shield promises because they are more like operators
+     in a programming language. the innermost promise frame is indexed by
+     the stack, so only the closure frames above it are visited. */
+    DenotedValue* find_side_effect_promise_(const SEXP env) const {
+        const ExecutionContextStack& stack = stack_;
+
+        if (stack.is_empty()) {
+            return nullptr;
         }
+
+        const int promise_index = stack.peek(1).get_promise_index();
+
+        if (promise_index < 0 || stack.has_closure_above(env, promise_index)) {
+            return nullptr;
+        }
+
+        return stack.get(promise_index).get_promise();
     }
 
+  public:
     void notify_caller(Call* callee) {
+        notify_caller(callee->is_wrapper());
+    }
+
+    void notify_caller(bool callee_wrapper) {
         ExecutionContextStack& stack = get_stack_();
 
         if (!stack.is_empty()) {
-            ExecutionContext exec_ctxt = stack.peek(1);
+            const ExecutionContext& exec_ctxt = stack.peek(1);
 
-            if (!exec_ctxt.is_call()) {
+            /* compact call frames do not take part in wrapper analysis. */
+            if (!exec_ctxt.has_call()) {
                 return;
             }
 
             Call* caller = exec_ctxt.get_call();
             Function* function = caller->get_function();
             if (function->is_closure() || function->is_curly_bracket()) {
-                caller->analyze_callee(callee);
+                caller->analyze_callee(callee_wrapper);
             }
         }
     }
@@ -1279,7 +1875,7 @@ class TracerState {
 
         for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter) {
             ExecutionContext& exec_ctxt = *iter;
-            if (exec_ctxt.get_type() == call_type) {
+            if (exec_ctxt.get_type() == call_type && exec_ctxt.has_call()) {
                 if (depth == 1) {
                     return exec_ctxt.get_call();
                 }
@@ -1341,18 +1937,55 @@ class TracerState {
 
     void serialize_promise_lifecycle_summary_() {
         for (const auto& summary: lifecycle_summary_) {
-            promise_lifecycles_data_table_->write_row(
+            table_writer_.write_row(
+                promise_lifecycles_data_table_,
                 summary.first.action,
                 pos_seq_to_string(summary.first.count),
                 summary.second);
         }
     }
 
+    void serialize_promise_lifecycle_deltas_() {
+        checkpointed_lifecycle_counts_.resize(lifecycle_summary_.size(), 0);
+
+        for (std::size_t i = 0; i < lifecycle_summary_.size(); ++i) {
+            const auto& summary = lifecycle_summary_[i];
+            const int delta =
+                summary.second - checkpointed_lifecycle_counts_[i];
+
+            if (delta != 0) {
+                table_writer_.write_row(
+                    promise_lifecycle_deltas_data_table_,
+                    checkpoint_,
+                    summary.first.action,
+                    pos_seq_to_string(summary.first.count),
+                    delta);
+                checkpointed_lifecycle_counts_[i] = summary.second;
+            }
+        }
+    }
+
   private:
     call_id_t call_id_counter_;
     std::vector<unsigned int> object_count_;
     std::vector<std::pair<lifecycle_t, int>> lifecycle_summary_;
     std::vector<unsigned long int> event_counter_;
+    /* the number of the next checkpoint and the counts at the previous
+       one. */
+    int checkpoint_;
+    std::vector<unsigned int> checkpointed_object_count_;
+    std::vector<int> checkpointed_lifecycle_counts_;
+    std::vector<unsigned long int> checkpointed_event_counter_;
+    std::chrono::steady_clock::time_point last_checkpoint_time_;
+    std::vector<Histogram> probe_histograms_;
+    ObjectPool<Call> call_pool_;
+    ObjectPool<Argument> argument_pool_;
+    ObjectPool<DenotedValue> denoted_value_pool_;
+    std::mt19937 sampling_generator_;
+    SexpMap<int> call_site_countdowns_;
+    std::size_t environment_high_water_mark_;
+    std::size_t function_high_water_mark_;
+    std::size_t variable_high_water_mark_;
 };
 
 #endif /* DYNAMISMTRACER_TRACER_STATE_H */
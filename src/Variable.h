@@ -7,12 +7,12 @@ typedef int var_id_t;
 
 class Variable {
   public:
-    Variable(const std::string& name,
+    Variable(const SEXP symbol,
              const var_id_t id,
              const timestamp_t modification_timestamp,
              const SEXP rho,
              const env_id_t env_id)
-        : name_(name)
+        : symbol_(symbol)
         , id_(id)
         , modification_timestamp_(modification_timestamp)
         , rho_(rho)
@@ -23,8 +23,13 @@ class Variable {
         return id_;
     }
 
-    const std::string& get_name() const {
-        return name_;
+    SEXP get_symbol() const {
+        return symbol_;
+    }
+
+    /* the name is only rendered when it is needed for output. */
+    std::string get_name() const {
+        return symbol_to_string(symbol_);
     }
 
     void set_modification_timestamp(timestamp_t modification_timestamp) {
@@ -43,33 +48,13 @@ class Variable {
         return env_id_;
     }
 
+    /* R flags the symbols of the form ..n when it interns them. */
     bool is_dot_dot_dot() const {
-        const std::string& name = get_name();
-        if (name.size() < 2) {
-            return false;
-        }
-
-        /* first we check that the variable starts with .. */
-        if (name[0] != '.' || name[1] != '.')
-            return false;
-        /* now we check that the variable ends with
-           a sequence of digits. */
-        for (int i = 2; i < name.size(); ++i) {
-            if (name[i] > '9' || name[i] < '0') {
-                return false;
-            }
-        }
-
-        /* if we reach here, its because the variable name has the form
-           ..n where n is a number >= 0. Because indexing in R starts
-           from 1, ..0 will never occur but the code above will still let
-           ..0 pass to this point. This should not be a problem in practice.
-        */
-        return true;
+        return DDVAL(symbol_);
     }
 
   private:
-    const std::string name_;
+    const SEXP symbol_;
     const var_id_t id_;
     timestamp_t modification_timestamp_;
     const SEXP rho_;
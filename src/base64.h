@@ -1,14 +0,0 @@
-//
-//  base64 encoding and decoding with C++.
-//  Version: 1.01.00
-//
-
-#ifndef BASE64_H_C0CE2A47_D10E_42C9_A27C_C883944E704A
-#define BASE64_H_C0CE2A47_D10E_42C9_A27C_C883944E704A
-
-#include <string>
-
-std::string base64_encode(unsigned char const*, unsigned int in_len);
-std::string base64_decode(std::string const& encoded_string);
-
-#endif /* BASE64_H_C0CE2A47_D10E_42C9_A27C_C883944E704A */
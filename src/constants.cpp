@@ -10,6 +10,7 @@ const eval_depth_t UNASSIGNED_PROMISE_EVAL_DEPTH = {-1, -1, -1, -1};
 
 const size_t PROMISE_MAPPING_BUCKET_COUNT = 1000000;
 const size_t FUNCTION_MAPPING_BUCKET_SIZE = 20000;
+const size_t ENVIRONMENT_MAPPING_BUCKET_COUNT = 100000;
 
 const std::vector<std::string> ENVIRONMENT_VARIABLES{"R_COMPILE_PKGS",
                                                      "R_DISABLE_BYTECODE",
@@ -32,7 +33,15 @@ const int UNASSIGNED_ACTUAL_ARGUMENT_POSITION = -1;
 
 const int UNASSIGNED_FORMAL_PARAMETER_COUNT = -1;
 
+const int UNASSIGNED_EXPRESSION_ID = -1;
+
 const unsigned int OBJECT_TYPE_TABLE_COUNT = 100;
 
+const std::size_t OBJECT_POOL_SLAB_SIZE = 1024;
+
+/* the number of events between two reads of the clock that decides if a
+   checkpoint is due. */
+const timestamp_t CHECKPOINT_CLOCK_CHECK_INTERVAL = 4096;
+
 const scope_t UNASSIGNED_SCOPE = "Unassigned";
 const scope_t TOP_LEVEL_SCOPE = "Top Level";
@@ -14,6 +14,7 @@ extern const eval_depth_t UNASSIGNED_PROMISE_EVAL_DEPTH;
 
 extern const std::size_t PROMISE_MAPPING_BUCKET_COUNT;
 extern const std::size_t FUNCTION_MAPPING_BUCKET_SIZE;
+extern const std::size_t ENVIRONMENT_MAPPING_BUCKET_COUNT;
 
 extern const std::vector<std::string> ENVIRONMENT_VARIABLES;
 
@@ -33,8 +34,14 @@ extern const int UNASSIGNED_ACTUAL_ARGUMENT_POSITION;
 
 extern const int UNASSIGNED_FORMAL_PARAMETER_COUNT;
 
+extern const int UNASSIGNED_EXPRESSION_ID;
+
 extern const unsigned int OBJECT_TYPE_TABLE_COUNT;
 
+extern const std::size_t OBJECT_POOL_SLAB_SIZE;
+
+extern const timestamp_t CHECKPOINT_CLOCK_CHECK_INTERVAL;
+
 extern const scope_t UNASSIGNED_SCOPE;
 extern const scope_t TOP_LEVEL_SCOPE;
 
@@ -1,6 +1,8 @@
 #ifndef DYNAMISMTRACER_DEFINITIONS_H
 #define DYNAMISMTRACER_DEFINITIONS_H
 
+#include "InlineVector.h"
+
 #include <string>
 #include <vector>
 
@@ -20,7 +22,11 @@ struct eval_depth_t {
     int forcing_actual_argument_position;
 };
 
-typedef std::vector<int> pos_seq_t;
+/* position sequences are kept in place up to this length, which covers the
+   arity of almost all functions. */
+const std::size_t INLINE_POSITION_COUNT = 16;
+
+typedef InlineVector<int, INLINE_POSITION_COUNT> pos_seq_t;
 
 struct lifecycle_t {
     std::string action;
@@ -0,0 +1,177 @@
+#include "hash.h"
+
+#include <cstring>
+
+/* hashed in place of the characters of NA_STRING, which would otherwise hash
+   like the string "NA". */
+static const std::uint64_t NA_STRING_MARKER = 0x9e3779b97f4a7c15ULL;
+
+static inline std::uint64_t finalize(std::uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+void Hasher::update(const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t word = 0;
+
+    /* the size is hashed first so that adjacent byte sequences cannot be
+       shifted into each other. */
+    update(static_cast<std::uint64_t>(size));
+
+    for (; size >= sizeof(word); size -= sizeof(word)) {
+        std::memcpy(&word, bytes, sizeof(word));
+        update(word);
+        bytes += sizeof(word);
+    }
+
+    if (size > 0) {
+        word = 0;
+        std::memcpy(&word, bytes, size);
+        update(word);
+    }
+}
+
+void Hasher::update(const char* str) {
+    update(str, std::strlen(str));
+}
+
+hash128_t Hasher::digest() const {
+    std::uint64_t low = low_ ^ length_;
+    std::uint64_t high = high_ ^ length_;
+
+    low += high;
+    high += low;
+
+    low = finalize(low);
+    high = finalize(high);
+
+    low += high;
+    high += low;
+
+    return {low, high};
+}
+
+static void hash_vector_elements(Hasher& hasher, SEXP sexp) {
+    R_xlen_t length = XLENGTH(sexp);
+
+    for (R_xlen_t index = 0; index < length; ++index) {
+        hash_sexp(hasher, VECTOR_ELT(sexp, index));
+    }
+}
+
+void hash_sexp(Hasher& hasher, SEXP sexp) {
+    /* pairlists are walked iteratively along their CDR so that long
+       argument lists and function bodies do not exhaust the C stack. */
+    while (true) {
+        const int type = TYPEOF(sexp);
+
+        hasher.update(static_cast<std::uint64_t>(type));
+
+        switch (type) {
+        case SYMSXP:
+            hasher.update(CHAR(PRINTNAME(sexp)));
+            return;
+
+        case CHARSXP:
+            if (sexp == NA_STRING) {
+                hasher.update(NA_STRING_MARKER);
+            } else {
+                hasher.update(CHAR(sexp));
+            }
+            return;
+
+        case LISTSXP:
+        case LANGSXP:
+        case DOTSXP:
+            hash_sexp(hasher, TAG(sexp));
+            hash_sexp(hasher, CAR(sexp));
+            sexp = CDR(sexp);
+            break;
+
+        case CLOSXP:
+            hash_sexp(hasher, FORMALS(sexp));
+            sexp = BODY(sexp);
+            break;
+
+        case PROMSXP:
+            sexp = dyntrace_get_promise_expression(sexp);
+            break;
+
+        case BCODESXP:
+            /* the first constant of the bytecode is the expression it was
+               compiled from. */
+            sexp = VECTOR_ELT(BCODE_CONSTS(sexp), 0);
+            break;
+
+        case SPECIALSXP:
+        case BUILTINSXP:
+            hasher.update(CHAR(PRIMNAME(sexp)));
+            return;
+
+        case LGLSXP:
+            hasher.update(LOGICAL(sexp), XLENGTH(sexp) * sizeof(int));
+            return;
+
+        case INTSXP:
+            hasher.update(INTEGER(sexp), XLENGTH(sexp) * sizeof(int));
+            return;
+
+        case REALSXP:
+            hasher.update(REAL(sexp), XLENGTH(sexp) * sizeof(double));
+            return;
+
+        case CPLXSXP:
+            hasher.update(COMPLEX(sexp), XLENGTH(sexp) * sizeof(Rcomplex));
+            return;
+
+        case RAWSXP:
+            hasher.update(RAW(sexp), XLENGTH(sexp));
+            return;
+
+        case STRSXP: {
+            R_xlen_t length = XLENGTH(sexp);
+            hasher.update(static_cast<std::uint64_t>(length));
+            for (R_xlen_t index = 0; index < length; ++index) {
+                hash_sexp(hasher, STRING_ELT(sexp, index));
+            }
+            return;
+        }
+
+        case VECSXP:
+        case EXPRSXP:
+            hasher.update(static_cast<std::uint64_t>(XLENGTH(sexp)));
+            hash_vector_elements(hasher, sexp);
+            return;
+
+        /* NILSXP terminates pairlists. environments, external pointers and
+           other reference objects have no structure that is stable across
+           sessions, so only their type contributes to the hash. */
+        default:
+            return;
+        }
+    }
+}
+
+std::string hash_to_string(const hash128_t& hash) {
+    /* 22 digits of 6 bits, from the base64 alphabet with '/' replaced by
+       '#' so that ids can be used as file names. */
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                   "abcdefghijklmnopqrstuvwxyz"
+                                   "0123456789+#";
+    char buffer[22];
+    std::uint64_t low = hash.low;
+    std::uint64_t high = hash.high;
+
+    for (int i = 0; i < 22; ++i) {
+        buffer[i] = alphabet[low & 0x3f];
+        low = (low >> 6) | (high << 58);
+        high >>= 6;
+    }
+
+    return std::string(buffer, sizeof(buffer));
+}
@@ -0,0 +1,77 @@
+#ifndef DYNAMISMTRACER_HASH_H
+#define DYNAMISMTRACER_HASH_H
+
+#include "stdlibs.h"
+
+#include <cstdint>
+#include <string>
+
+struct hash128_t {
+    std::uint64_t low;
+    std::uint64_t high;
+};
+
+inline bool operator==(const hash128_t& left, const hash128_t& right) {
+    return left.low == right.low && left.high == right.high;
+}
+
+/* the hash is already mixed, so unordered containers can use its low word
+   as is. */
+struct hash128_hash {
+    std::size_t operator()(const hash128_t& hash) const {
+        return hash.low;
+    }
+};
+
+/* a streaming 128 bit non cryptographic hash. the block and finalization
+   steps are those of MurmurHash3 x64 128, applied to one 64 bit word at a
+   time. */
+class Hasher {
+  public:
+    explicit Hasher(std::uint64_t seed = 0)
+        : low_(seed), high_(seed), length_(0) {
+    }
+
+    void update(std::uint64_t word) {
+        std::uint64_t k1 = word * C1_;
+        k1 = rotate_left_(k1, 31) * C2_;
+        low_ ^= k1;
+        low_ = rotate_left_(low_, 27) + high_;
+        low_ = low_ * 5 + 0x52dce729;
+
+        std::uint64_t k2 = word * C2_;
+        k2 = rotate_left_(k2, 33) * C1_;
+        high_ ^= k2;
+        high_ = rotate_left_(high_, 31) + low_;
+        high_ = high_ * 5 + 0x38495ab5;
+
+        length_ += sizeof(word);
+    }
+
+    void update(const void* data, std::size_t size);
+
+    void update(const char* str);
+
+    hash128_t digest() const;
+
+  private:
+    static std::uint64_t rotate_left_(std::uint64_t value, int shift) {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    std::uint64_t low_;
+    std::uint64_t high_;
+    std::uint64_t length_;
+
+    static const std::uint64_t C1_ = 0x87c37b91114253d5ULL;
+    static const std::uint64_t C2_ = 0x4cf5ad432745937fULL;
+};
+
+/* hashes the structure of an R object by walking it natively. symbols and
+   strings are hashed by their contents, so the hash is stable across R
+   sessions. the walk never allocates on the R heap. */
+void hash_sexp(Hasher& hasher, SEXP sexp);
+
+std::string hash_to_string(const hash128_t& hash);
+
+#endif /* DYNAMISMTRACER_HASH_H */
@@ -9,8 +9,12 @@ extern "C" {
 #endif
 
 static const R_CallMethodDef CallEntries[] = {
-    {"create_dyntracer", (DL_FUNC) &create_dyntracer, 5},
+    {"create_dyntracer", (DL_FUNC) &create_dyntracer, 14},
     {"destroy_dyntracer", (DL_FUNC) &destroy_dyntracer, 1},
+    {"create_recorder", (DL_FUNC) &create_recorder, 2},
+    {"destroy_recorder", (DL_FUNC) &destroy_recorder, 1},
+    {"replay_event_log", (DL_FUNC) &replay_event_log, 8},
+    {"replay_event_logs", (DL_FUNC) &replay_event_logs, 10},
     {NULL, NULL, 0}};
 
 void attribute_visible R_init_dynamismtracer(DllInfo* dll) {
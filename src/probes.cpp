@@ -35,8 +35,7 @@ void dyntrace_exit(dyntracer_t* dyntracer,
      executing and we don't need to resume the timer. */
 }
 
-static inline void set_dispatch(Call* call,
-                                const dyntrace_dispatch_t dispatch) {
+void set_dispatch(Call* call, const dyntrace_dispatch_t dispatch) {
     if (dispatch == DYNTRACE_DISPATCH_S3) {
         call->set_S3_method();
     } else if (dispatch == DYNTRACE_DISPATCH_S4) {
@@ -44,12 +43,51 @@ static inline void set_dispatch(Call* call,
     }
 }
 
-void eval_entry(dyntracer_t* dyntracer, const SEXP expr, const SEXP rho) {
-    TracerState& state = tracer_state(dyntracer);
+/* pushes a compact frame for primitives that do not need a Call object. For
+ the rest, a Call object is created, pushed and returned. */
+static inline Call* enter_primitive(TracerState& state,
+                                    const SEXP call,
+                                    const SEXP op,
+                                    const SEXP args,
+                                    const SEXP rho,
+                                    const dyntrace_dispatch_t dispatch) {
+    Function* function = state.lookup_function(op, get_name(call));
+
+    if (!state.needs_call(function)) {
+        state.push_stack(function, get_name(call), rho, dispatch);
+        return nullptr;
+    }
 
-    state.enter_probe(Event::EvalEntry);
+    Call* function_call = state.create_call(call, op, function, args, rho);
+
+    set_dispatch(function_call, dispatch);
 
-    state.exit_probe(Event::EvalEntry);
+    state.push_stack(function_call);
+
+    return function_call;
+}
+
+void exit_call(TracerState& state,
+               ExecutionContext& exec_ctxt,
+               const sexptype_t return_value_type) {
+    if (!exec_ctxt.has_call()) {
+        state.destroy_compact_call(exec_ctxt, return_value_type, false);
+        return;
+    }
+
+    Call* function_call = exec_ctxt.get_call();
+
+    function_call->set_return_value_type(return_value_type);
+
+    state.notify_caller(function_call);
+
+    state.destroy_call(function_call);
+}
+
+void eval_entry(dyntracer_t* dyntracer, const SEXP expr, const SEXP rho) {
+    /* eval is the most frequent event by far. it is only counted, reading
+     the clock here would dominate the tracing overhead. */
+    tracer_state(dyntracer).count_event(Event::EvalEntry);
 }
 
 void closure_entry(dyntracer_t* dyntracer,
@@ -62,7 +100,16 @@ void closure_entry(dyntracer_t* dyntracer,
 
     state.enter_probe(Event::ClosureEntry);
 
-    Call* function_call = state.create_call(call, op, args, rho);
+    Function* function = state.lookup_function(op, get_name(call));
+
+    /* closure calls that are not sampled are traced with compact frames. */
+    if (!state.sample_call(function, call)) {
+        state.push_stack(function, get_name(call), rho, dispatch);
+        state.exit_probe(Event::ClosureEntry);
+        return;
+    }
+
+    Call* function_call = state.create_call(call, op, function, args, rho);
 
     // static int loopy = 1;
     // if(function_call -> get_function() -> get_id() ==
@@ -103,13 +150,7 @@ void closure_exit(dyntracer_t* dyntracer,
         dyntrace_log_error("Not found matching closure on stack");
     }
 
-    Call* function_call = exec_ctxt.get_closure();
-
-    function_call->set_return_value_type(type_of_sexp(return_value));
-
-    state.notify_caller(function_call);
-
-    state.destroy_call(function_call);
+    exit_call(state, exec_ctxt, type_of_sexp(return_value));
 
     state.exit_probe(Event::ClosureExit);
 }
@@ -124,11 +165,7 @@ void builtin_entry(dyntracer_t* dyntracer,
 
     state.enter_probe(Event::BuiltinEntry);
 
-    Call* function_call = state.create_call(call, op, args, rho);
-
-    set_dispatch(function_call, dispatch);
-
-    state.push_stack(function_call);
+    enter_primitive(state, call, op, args, rho, dispatch);
 
     state.exit_probe(Event::BuiltinEntry);
 }
@@ -150,13 +187,7 @@ void builtin_exit(dyntracer_t* dyntracer,
         dyntrace_log_error("Not found matching builtin on stack");
     }
 
-    Call* function_call = exec_ctxt.get_builtin();
-
-    function_call->set_return_value_type(type_of_sexp(return_value));
-
-    state.notify_caller(function_call);
-
-    state.destroy_call(function_call);
+    exit_call(state, exec_ctxt, type_of_sexp(return_value));
 
     state.exit_probe(Event::BuiltinExit);
 }
@@ -171,17 +202,14 @@ void special_entry(dyntracer_t* dyntracer,
 
     state.enter_probe(Event::SpecialEntry);
 
-    Call* function_call = state.create_call(call, op, args, rho);
+    Call* function_call =
+        enter_primitive(state, call, op, args, rho, dispatch);
 
-    std::string function_name = function_call->get_function_name();
-    if (function_name.compare("<<-") == 0) {
+    if (function_call != nullptr &&
+        function_call->get_function()->is_super_assign()) {
         state.process_dynamic_calls_for_specials(function_call);
     }
 
-    set_dispatch(function_call, dispatch);
-
-    state.push_stack(function_call);
-
     state.exit_probe(Event::SpecialEntry);
 }
 
@@ -202,23 +230,17 @@ void special_exit(dyntracer_t* dyntracer,
         dyntrace_log_error("Not found matching special object on stack");
     }
 
-    Call* function_call = exec_ctxt.get_special();
-
-    function_call->set_return_value_type(type_of_sexp(return_value));
-
-    state.notify_caller(function_call);
-
-    state.destroy_call(function_call);
+    exit_call(state, exec_ctxt, type_of_sexp(return_value));
 
     state.exit_probe(Event::SpecialExit);
 }
 
-void jump_single_context(TracerState& state,
+static void jump_single_context(TracerState& state,
                          ExecutionContext& exec_ctxt,
                          bool returned,
                          const sexptype_t return_value_type,
                          const SEXP rho) {
-    if (exec_ctxt.is_call()) {
+    if (exec_ctxt.has_call()) {
         Call* call = exec_ctxt.get_call();
 
         call->set_jumped();
@@ -229,6 +251,10 @@ void jump_single_context(TracerState& state,
         state.destroy_call(call);
     }
 
+    else if (exec_ctxt.is_call()) {
+        state.destroy_compact_call(exec_ctxt, return_value_type, true);
+    }
+
     else if (exec_ctxt.is_promise()) {
         DenotedValue* promise = exec_ctxt.get_promise();
 
@@ -249,6 +275,18 @@ void context_jump(dyntracer_t* dyntracer,
 
     state.enter_probe(Event::ContextJump);
 
+    execution_contexts_t exec_ctxts(state.unwind_stack(context));
+
+    jump_contexts(
+        state, exec_ctxts, type_of_sexp(return_value), context->cloenv);
+
+    state.exit_probe(Event::ContextJump);
+}
+
+void jump_contexts(TracerState& state,
+                   execution_contexts_t& exec_ctxts,
+                   const sexptype_t return_value_type,
+                   const SEXP rho) {
     /* Identify promises that do non local return. First, check if
      this special is a 'return', then check if the return happens
      right after a promise is forced, then walk back in the stack
@@ -258,10 +296,6 @@ void context_jump(dyntracer_t* dyntracer,
      because only one promise can be held responsible for non local
      return, the one that invokes the return function. */
 
-    execution_contexts_t exec_ctxts(state.unwind_stack(context));
-
-    const SEXP rho = context->cloenv;
-
     std::size_t context_count = exec_ctxts.size();
 
     if (context_count == 0) {
@@ -271,19 +305,15 @@ void context_jump(dyntracer_t* dyntracer,
         auto begin_iter = exec_ctxts.begin();
         auto end_iter = --exec_ctxts.end();
 
-        bool returned =
-            (begin_iter->is_special() &&
-             begin_iter->get_special()->get_function()->is_return());
+        bool returned = (begin_iter->is_special() &&
+                         begin_iter->get_function()->is_return());
 
         for (auto iter = begin_iter; iter != end_iter; ++iter) {
             jump_single_context(state, *iter, returned, JUMPSXP, rho);
         }
 
-        jump_single_context(
-            state, *end_iter, returned, type_of_sexp(return_value), rho);
+        jump_single_context(state, *end_iter, returned, return_value_type, rho);
     }
-
-    state.exit_probe(Event::ContextJump);
 }
 
 void context_exit(dyntracer_t* dyntracer, const RCNTXT* cptr) {
@@ -309,3 +339,31 @@ void context_entry(dyntracer_t* dyntracer, const RCNTXT* cptr) {
 
     state.exit_probe(Event::ContextEntry);
 }
+
+void gc_unmark(dyntracer_t* dyntracer, const SEXP object) {
+    TracerState& state = tracer_state(dyntracer);
+
+    state.enter_probe(Event::GcUnmark);
+
+    /* R is about to reclaim this object. Its address can be recycled for a
+     new object at any point after this, so the state mapped to it has to be
+     released now. Otherwise, it will alias the state of the new object. */
+    switch (type_of_sexp(object)) {
+    case PROMSXP:
+        state.remove_promise(object);
+        break;
+    case CLOSXP:
+        state.remove_function(object);
+        break;
+    case ENVSXP:
+        state.remove_environment(object);
+        break;
+    case LANGSXP:
+        state.remove_call_site(object);
+        break;
+    default:
+        break;
+    }
+
+    state.exit_probe(Event::GcUnmark);
+}
@@ -7,6 +7,20 @@
 #define R_USE_SIGNALS 1
 #include "Defn.h"
 
+/* stack bookkeeping shared by the probes and the event log replay. */
+void set_dispatch(Call* call, const dyntrace_dispatch_t dispatch);
+
+void exit_call(TracerState& state,
+               ExecutionContext& exec_ctxt,
+               const sexptype_t return_value_type);
+
+/* the exec_ctxts are the frames unwound by a jump, innermost first. rho is
+ the environment of the context the jump lands in. */
+void jump_contexts(TracerState& state,
+                   execution_contexts_t& exec_ctxts,
+                   const sexptype_t return_value_type,
+                   const SEXP rho);
+
 extern "C" {
 
 void dyntrace_entry(dyntracer_t* dyntracer, SEXP expression, SEXP environment);
@@ -72,5 +86,7 @@ void context_jump(dyntracer_t* dyntracer,
                   int restart);
 
 void context_exit(dyntracer_t* dyntracer, const RCNTXT*);
+
+void gc_unmark(dyntracer_t* dyntracer, const SEXP object);
 };
 #endif /* DYNAMISMTRACER_PROBES_H */
@@ -0,0 +1,104 @@
+#include "recorder_probes.h"
+
+inline Recorder& recorder(dyntracer_t* dyntracer) {
+    return *(static_cast<Recorder*>(dyntracer->state));
+}
+
+void record_dyntrace_entry(dyntracer_t* dyntracer,
+                           SEXP expression,
+                           SEXP environment) {
+    recorder(dyntracer).initialize();
+}
+
+void record_dyntrace_exit(dyntracer_t* dyntracer,
+                          SEXP expression,
+                          SEXP environment,
+                          SEXP result,
+                          int error) {
+    recorder(dyntracer).cleanup(error);
+}
+
+void record_eval_entry(dyntracer_t* dyntracer,
+                       const SEXP expr,
+                       const SEXP rho) {
+    recorder(dyntracer).count_eval();
+}
+
+void record_closure_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch) {
+    recorder(dyntracer).record_call_entry(
+        Event::ClosureEntry, call, op, args, rho, dispatch);
+}
+
+void record_closure_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value) {
+    recorder(dyntracer).record_call_exit(Event::ClosureExit, return_value);
+}
+
+void record_builtin_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch) {
+    recorder(dyntracer).record_call_entry(
+        Event::BuiltinEntry, call, op, args, rho, dispatch);
+}
+
+void record_builtin_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value) {
+    recorder(dyntracer).record_call_exit(Event::BuiltinExit, return_value);
+}
+
+void record_special_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch) {
+    recorder(dyntracer).record_call_entry(
+        Event::SpecialEntry, call, op, args, rho, dispatch);
+}
+
+void record_special_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value) {
+    recorder(dyntracer).record_call_exit(Event::SpecialExit, return_value);
+}
+
+void record_context_entry(dyntracer_t* dyntracer, const RCNTXT* cptr) {
+    recorder(dyntracer).record_context_entry(cptr);
+}
+
+void record_context_jump(dyntracer_t* dyntracer,
+                         const RCNTXT* context,
+                         const SEXP return_value,
+                         int restart) {
+    recorder(dyntracer).record_context_jump(context, return_value);
+}
+
+void record_context_exit(dyntracer_t* dyntracer, const RCNTXT* cptr) {
+    recorder(dyntracer).record_context_exit(cptr);
+}
+
+void record_gc_unmark(dyntracer_t* dyntracer, const SEXP object) {
+    recorder(dyntracer).record_gc_unmark(object);
+}
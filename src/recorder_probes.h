@@ -0,0 +1,82 @@
+#ifndef DYNAMISMTRACER_RECORDER_PROBES_H
+#define DYNAMISMTRACER_RECORDER_PROBES_H
+
+#include "Recorder.h"
+#include "utilities.h"
+
+#define R_USE_SIGNALS 1
+#include "Defn.h"
+
+/* The probes of the record mode. They append to the event log of the
+ Recorder in dyntracer->state and do not maintain any analysis state. */
+extern "C" {
+
+void record_dyntrace_entry(dyntracer_t* dyntracer,
+                           SEXP expression,
+                           SEXP environment);
+
+void record_dyntrace_exit(dyntracer_t* dyntracer,
+                          SEXP expression,
+                          SEXP environment,
+                          SEXP result,
+                          int error);
+
+void record_eval_entry(dyntracer_t* dyntracer, const SEXP expr, const SEXP rho);
+
+void record_closure_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch);
+
+void record_closure_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value);
+
+void record_builtin_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch);
+
+void record_builtin_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value);
+
+void record_special_entry(dyntracer_t* dyntracer,
+                          const SEXP call,
+                          const SEXP op,
+                          const SEXP args,
+                          const SEXP rho,
+                          const dyntrace_dispatch_t dispatch);
+
+void record_special_exit(dyntracer_t* dyntracer,
+                         const SEXP call,
+                         const SEXP op,
+                         const SEXP args,
+                         const SEXP rho,
+                         const dyntrace_dispatch_t dispatch,
+                         const SEXP return_value);
+
+void record_context_entry(dyntracer_t* dyntracer, const RCNTXT*);
+
+void record_context_jump(dyntracer_t* dyntracer,
+                         const RCNTXT*,
+                         SEXP return_value,
+                         int restart);
+
+void record_context_exit(dyntracer_t* dyntracer, const RCNTXT*);
+
+void record_gc_unmark(dyntracer_t* dyntracer, const SEXP object);
+};
+#endif /* DYNAMISMTRACER_RECORDER_PROBES_H */
@@ -0,0 +1,319 @@
+#ifndef DYNAMISMTRACER_SCHEMAS_H
+#define DYNAMISMTRACER_SCHEMAS_H
+
+#include "Dictionary.h"
+#include "Table.h"
+
+#include <string>
+#include <tuple>
+
+/* The schemas of the tables written by the tracer. Counts that may not fit
+   in an int are written as doubles. */
+
+struct EventCountsSchema {
+    static constexpr const char* NAME = "event_counts";
+    static constexpr auto COLUMNS =
+        std::make_tuple(Column<std::string>{"event"}, Column<double>{"count"});
+};
+
+struct ObjectCountsSchema {
+    static constexpr const char* NAME = "object_counts";
+    static constexpr auto COLUMNS =
+        std::make_tuple(Column<std::string>{"type"}, Column<double>{"count"});
+};
+
+struct CallSummariesSchema {
+    static constexpr const char* NAME = "call_summaries";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"function_id"},
+        Column<Category>{"package"},
+        Column<Category>{"function_name"},
+        Column<Category>{"function_type"},
+        Column<int>{"formal_parameter_count"},
+        Column<bool>{"wrapper"},
+        Column<bool>{"S3_method"},
+        Column<bool>{"S4_method"},
+        Column<std::string>{"force_order"},
+        Column<std::string>{"missing_arguments"},
+        Column<Category>{"return_value_type"},
+        Column<bool>{"jumped"},
+        Column<int>{"call_count"});
+};
+
+struct DynamicCallSummariesSchema {
+    static constexpr const char* NAME = "dynamic_call_summaries";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"function_id"},
+        /* the summarizer groups these across traces, whose dictionaries
+           differ, so they are not encoded. */
+        Column<std::string>{"package"},
+        Column<std::string>{"function_name"},
+        Column<Category>{"function_type"},
+        Column<int>{"formal_parameter_count"},
+        Column<bool>{"S3_method"},
+        Column<bool>{"S4_method"},
+        Column<Category>{"return_value_type"},
+        Column<int>{"call_count"},
+        Column<int>{"dyn_call_count"});
+};
+
+struct FunctionDefinitionsSchema {
+    static constexpr const char* NAME = "function_definitions";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"function_id"},
+        Column<std::string>{"package"},
+        Column<std::string>{"function_name"},
+        Column<int>{"formal_parameter_count"},
+        Column<bool>{"byte_compiled"},
+        Column<std::string>{"definition"});
+};
+
+struct ArgumentsSchema {
+    static constexpr const char* NAME = "arguments";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"call_id"},
+        Column<std::string>{"function_id"},
+        Column<int>{"value_id"},
+        Column<int>{"formal_parameter_position"},
+        Column<int>{"actual_argument_position"},
+        Column<Category>{"argument_type"},
+        Column<Category>{"expression_type"},
+        Column<Category>{"value_type"},
+        Column<bool>{"default"},
+        Column<bool>{"dot_dot_dot"},
+        Column<bool>{"preforce"},
+        Column<bool>{"direct_force"},
+        Column<int>{"direct_lookup_count"},
+        Column<int>{"direct_metaprogram_count"},
+        Column<bool>{"indirect_force"},
+        Column<int>{"indirect_lookup_count"},
+        Column<int>{"indirect_metaprogram_count"},
+        Column<bool>{"S3_dispatch"},
+        Column<bool>{"S4_dispatch"},
+        Column<int>{"forcing_actual_argument_position"},
+        Column<bool>{"non_local_return"},
+        Column<double>{"execution_time"},
+        Column<int>{"expression_id"},
+        Column<int>{"weight"});
+};
+
+struct SideEffectsSchema {
+    static constexpr const char* NAME = "side_effects";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"value_id"},
+        Column<int>{"call_id"},
+        Column<std::string>{"function_id"},
+        Column<Category>{"package"},
+        Column<Category>{"function_name"},
+        Column<int>{"formal_parameter_position"},
+        Column<int>{"actual_argument_position"},
+        Column<bool>{"dot_dot_dot"},
+        Column<int>{"direct_self_scope_mutation_count"},
+        Column<int>{"indirect_self_scope_mutation_count"},
+        Column<int>{"direct_lexical_scope_mutation_count"},
+        Column<int>{"indirect_lexical_scope_mutation_count"},
+        Column<int>{"direct_non_lexical_scope_mutation_count"},
+        Column<int>{"indirect_non_lexical_scope_mutation_count"},
+        Column<int>{"direct_self_scope_observation_count"},
+        Column<int>{"indirect_self_scope_observation_count"},
+        Column<int>{"direct_lexical_scope_observation_count"},
+        Column<int>{"indirect_lexical_scope_observation_count"},
+        Column<int>{"direct_non_lexical_scope_observation_count"},
+        Column<int>{"indirect_non_lexical_scope_observation_count"},
+        Column<int>{"expression_id"},
+        Column<int>{"weight"});
+};
+
+struct EscapedArgumentsSchema {
+    static constexpr const char* NAME = "escaped_arguments";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"call_id"},
+        Column<std::string>{"function_id"},
+        Column<Category>{"return_value_type"},
+        Column<int>{"formal_parameter_count"},
+        Column<int>{"formal_parameter_position"},
+        Column<int>{"actual_argument_position"},
+        Column<int>{"value_id"},
+        Column<std::string>{"class"},
+        Column<int>{"S3_dispatch"},
+        Column<int>{"S4_dispatch"},
+        Column<Category>{"argument_type"},
+        Column<Category>{"expression_type"},
+        Column<Category>{"value_type"},
+        Column<bool>{"default"},
+        Column<bool>{"non_local_return"},
+        Column<bool>{"escape"},
+        Column<int>{"call_depth"},
+        Column<int>{"promise_depth"},
+        Column<int>{"nested_promise_depth"},
+        Column<int>{"forcing_actual_argument_position"},
+        Column<bool>{"preforce"},
+        Column<int>{"before_escape_force_count"},
+        Column<int>{"before_escape_metaprogram_count"},
+        Column<int>{"before_escape_value_lookup_count"},
+        Column<int>{"before_escape_value_assign_count"},
+        Column<int>{"before_escape_expression_lookup_count"},
+        Column<int>{"before_escape_expression_assign_count"},
+        Column<int>{"before_escape_environment_lookup_count"},
+        Column<int>{"before_escape_environment_assign_count"},
+        Column<int>{"after_escape_force_count"},
+        Column<int>{"after_escape_metaprogram_count"},
+        Column<int>{"after_escape_value_lookup_count"},
+        Column<int>{"after_escape_value_assign_count"},
+        Column<int>{"after_escape_expression_lookup_count"},
+        Column<int>{"after_escape_expression_assign_count"},
+        Column<int>{"after_escape_environment_lookup_count"},
+        Column<int>{"after_escape_environment_assign_count"},
+        Column<int>{"before_escape_direct_self_scope_mutation_count"},
+        Column<int>{"before_escape_indirect_self_scope_mutation_count"},
+        Column<int>{"before_escape_direct_lexical_scope_mutation_count"},
+        Column<int>{"before_escape_indirect_lexical_scope_mutation_count"},
+        Column<int>{"before_escape_direct_non_lexical_scope_mutation_count"},
+        Column<int>{"before_escape_indirect_non_lexical_scope_mutation_count"},
+        Column<int>{"before_escape_direct_self_scope_observation_count"},
+        Column<int>{"before_escape_indirect_self_scope_observation_count"},
+        Column<int>{"before_escape_direct_lexical_scope_observation_count"},
+        Column<int>{"before_escape_indirect_lexical_scope_observation_count"},
+        Column<int>{"before_escape_direct_non_lexical_scope_observation_count"},
+        Column<int>{
+            "before_escape_indirect_non_lexical_scope_observation_count"},
+        Column<int>{"after_escape_direct_self_scope_mutation_count"},
+        Column<int>{"after_escape_indirect_self_scope_mutation_count"},
+        Column<int>{"after_escape_direct_lexical_scope_mutation_count"},
+        Column<int>{"after_escape_indirect_lexical_scope_mutation_count"},
+        Column<int>{"after_escape_direct_non_lexical_scope_mutation_count"},
+        Column<int>{"after_escape_indirect_non_lexical_scope_mutation_count"},
+        Column<int>{"after_escape_direct_self_scope_observation_count"},
+        Column<int>{"after_escape_indirect_self_scope_observation_count"},
+        Column<int>{"after_escape_direct_lexical_scope_observation_count"},
+        Column<int>{"after_escape_indirect_lexical_scope_observation_count"},
+        Column<int>{"after_escape_direct_non_lexical_scope_observation_count"},
+        Column<int>{
+            "after_escape_indirect_non_lexical_scope_observation_count"},
+        Column<double>{"execution_time"});
+};
+
+struct PromisesSchema {
+    static constexpr const char* NAME = "promises";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"value_id"},
+        Column<bool>{"argument"},
+        Column<Category>{"expression_type"},
+        Column<Category>{"value_type"},
+        Column<std::string>{"creation_scope"},
+        Column<std::string>{"forcing_scope"},
+        Column<int>{"S3_dispatch"},
+        Column<int>{"S4_dispatch"},
+        Column<bool>{"preforce"},
+        Column<int>{"force_count"},
+        Column<int>{"call_depth"},
+        Column<int>{"promise_depth"},
+        Column<int>{"nested_promise_depth"},
+        Column<int>{"metaprogram_count"},
+        Column<int>{"value_lookup_count"},
+        Column<int>{"value_assign_count"},
+        Column<int>{"expression_lookup_count"},
+        Column<int>{"expression_assign_count"},
+        Column<int>{"environment_lookup_count"},
+        Column<int>{"environment_assign_count"},
+        Column<double>{"execution_time"});
+};
+
+struct PromiseLifecyclesSchema {
+    static constexpr const char* NAME = "promise_lifecycles";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"action"},
+        Column<std::string>{"count"},
+        Column<int>{"promise_count"});
+};
+
+struct ObjectPoolsSchema {
+    static constexpr const char* NAME = "object_pools";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"type"},
+        Column<double>{"slab_size"},
+        Column<double>{"slab_count"},
+        Column<double>{"allocation_count"},
+        Column<double>{"high_water_mark"});
+};
+
+struct TableWriterSchema {
+    static constexpr const char* NAME = "table_writer";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"queue_capacity"},
+        Column<double>{"row_count"},
+        Column<double>{"blocked_count"});
+};
+
+struct TracerMemorySchema {
+    static constexpr const char* NAME = "tracer_memory";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<double>{"event_count"},
+        Column<double>{"call_count"},
+        Column<double>{"call_high_water_mark"},
+        Column<double>{"argument_count"},
+        Column<double>{"argument_high_water_mark"},
+        Column<double>{"denoted_value_count"},
+        Column<double>{"denoted_value_high_water_mark"},
+        Column<double>{"function_count"},
+        Column<double>{"function_high_water_mark"},
+        Column<double>{"environment_count"},
+        Column<double>{"environment_high_water_mark"},
+        Column<double>{"variable_count"},
+        Column<double>{"variable_high_water_mark"},
+        Column<double>{"promises_bytes"},
+        Column<double>{"functions_bytes"},
+        Column<double>{"function_cache_bytes"},
+        Column<double>{"environment_mapping_bytes"},
+        Column<double>{"max_rss_bytes"});
+};
+
+struct ProbeOverheadSchema {
+    static constexpr const char* NAME = "probe_overhead";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<std::string>{"event"},
+        Column<double>{"count"},
+        Column<double>{"total"},
+        Column<double>{"p50"},
+        Column<double>{"p90"},
+        Column<double>{"p99"},
+        Column<double>{"max"});
+};
+
+/* the distinct expressions of the promise arguments. the arguments and
+   side_effects tables refer to them by id. */
+struct ExpressionsSchema {
+    static constexpr const char* NAME = "expressions";
+    static constexpr auto COLUMNS =
+        std::make_tuple(Column<int>{"expression_id"},
+                        Column<std::string>{"expression"});
+};
+
+/* the checkpoints written so far, with the number of events traced before
+   each of them. */
+struct CheckpointsSchema {
+    static constexpr const char* NAME = "checkpoints";
+    static constexpr auto COLUMNS = std::make_tuple(
+        Column<int>{"checkpoint"}, Column<double>{"event_count"});
+};
+
+/* the rows of a summary table written at checkpoints. their counts are the
+   increments since the previous checkpoint, so the rows of all checkpoints
+   add up to the summary table. the table is named after the summary table
+   with a _deltas suffix. */
+template <typename Schema>
+struct DeltasSchema {
+    static constexpr const char* NAME = "deltas";
+    static constexpr auto COLUMNS = std::tuple_cat(
+        std::make_tuple(Column<int>{"checkpoint"}), Schema::COLUMNS);
+};
+
+/* the codes of the categorical columns of a binary table. the table is
+   named after the table it belongs to. */
+struct DictionarySchema {
+    static constexpr const char* NAME = "dictionary";
+    static constexpr auto COLUMNS =
+        std::make_tuple(Column<int>{"code"}, Column<std::string>{"value"});
+};
+
+#endif /* DYNAMISMTRACER_SCHEMAS_H */
@@ -1,6 +1,86 @@
 #include "tracer.h"
 
+#include "ParallelReplayer.h"
+#include "Replayer.h"
 #include "probes.h"
+#include "recorder_probes.h"
+
+static std::vector<Analysis> sexp_to_analyses(SEXP analyses) {
+    std::vector<Analysis> result;
+
+    for (int i = 0; i < LENGTH(analyses); ++i) {
+        const std::string name = CHAR(STRING_ELT(analyses, i));
+        const Analysis analysis = string_to_analysis(name);
+
+        if (analysis == Analysis::COUNT) {
+            dyntrace_log_error("unknown analysis '%s'", name.c_str());
+            continue;
+        }
+
+        result.push_back(analysis);
+    }
+
+    return result;
+}
+
+static ClockType sexp_to_clock_type(SEXP clock) {
+    const std::string name = sexp_to_string(clock);
+    const ClockType clock_type = string_to_clock_type(name);
+
+    if (clock_type == ClockType::COUNT) {
+        dyntrace_log_error("unknown clock '%s'", name.c_str());
+    }
+
+    return clock_type;
+}
+
+static SamplingUnit sexp_to_sampling_unit(SEXP sampling_unit) {
+    const std::string name = sexp_to_string(sampling_unit);
+    const SamplingUnit unit = string_to_sampling_unit(name);
+
+    if (unit == SamplingUnit::COUNT) {
+        dyntrace_log_error("unknown sampling unit '%s'", name.c_str());
+    }
+
+    return unit;
+}
+
+/* the replay neither measures time nor samples calls. */
+static TracerState* create_replay_state(SEXP output_dirpath,
+                                        SEXP verbose,
+                                        SEXP truncate,
+                                        SEXP binary,
+                                        SEXP compression_level,
+                                        SEXP writer_queue_capacity,
+                                        SEXP analyses) {
+    std::vector<Analysis> replayed_analyses;
+
+    /* the log does not hold the R objects these analyses inspect. */
+    for (const Analysis analysis: sexp_to_analyses(analyses)) {
+        if (analysis == Analysis::Arguments || analysis == Analysis::Promises ||
+            analysis == Analysis::ProbeOverhead) {
+            dyntrace_log_error("analysis '%s' cannot be replayed",
+                               to_string(analysis).c_str());
+        } else {
+            replayed_analyses.push_back(analysis);
+        }
+    }
+
+    return new TracerState(sexp_to_string(output_dirpath),
+                           sexp_to_bool(verbose),
+                           sexp_to_bool(truncate),
+                           sexp_to_bool(binary),
+                           sexp_to_int(compression_level),
+                           sexp_to_int(writer_queue_capacity),
+                           replayed_analyses,
+                           ClockType::Off,
+                           1,
+                           SamplingUnit::Function,
+                           0,
+                           0,
+                           0,
+                           0);
+}
 
 extern "C" {
 
@@ -8,30 +88,71 @@ SEXP create_dyntracer(SEXP output_dirpath,
                       SEXP verbose,
                       SEXP truncate,
                       SEXP binary,
-                      SEXP compression_level) {
-    void* state = new TracerState(sexp_to_string(output_dirpath),
-                                  sexp_to_bool(verbose),
-                                  sexp_to_bool(truncate),
-                                  sexp_to_bool(binary),
-                                  sexp_to_int(compression_level));
+                      SEXP compression_level,
+                      SEXP writer_queue_capacity,
+                      SEXP analyses,
+                      SEXP clock,
+                      SEXP sampling_rate,
+                      SEXP sampling_unit,
+                      SEXP sampling_seed,
+                      SEXP memory_sampling_interval,
+                      SEXP checkpoint_event_interval,
+                      SEXP checkpoint_time_interval) {
+    TracerState* state = new TracerState(sexp_to_string(output_dirpath),
+                                         sexp_to_bool(verbose),
+                                         sexp_to_bool(truncate),
+                                         sexp_to_bool(binary),
+                                         sexp_to_int(compression_level),
+                                         sexp_to_int(writer_queue_capacity),
+                                         sexp_to_analyses(analyses),
+                                         sexp_to_clock_type(clock),
+                                         sexp_to_int(sampling_rate),
+                                         sexp_to_sampling_unit(sampling_unit),
+                                         sexp_to_int(sampling_seed),
+                                         sexp_to_int(memory_sampling_interval),
+                                         sexp_to_int(checkpoint_event_interval),
+                                         sexp_to_int(checkpoint_time_interval));
 
     /* calloc initializes the memory to zero. This ensures that probes not
      attached will be NULL. Replacing calloc with malloc will cause
      segfaults. */
     dyntracer_t* dyntracer = (dyntracer_t*) calloc(1, sizeof(dyntracer_t));
+    dyntracer->state = state;
+
+    /* only the probes consumed by the enabled analyses are attached. R does
+     not call into the tracer at all for the events of detached probes. */
     dyntracer->probe_dyntrace_entry = dyntrace_entry;
     dyntracer->probe_dyntrace_exit = dyntrace_exit;
-    dyntracer->probe_eval_entry = eval_entry;
-    dyntracer->probe_closure_entry = closure_entry;
-    dyntracer->probe_closure_exit = closure_exit;
-    dyntracer->probe_builtin_entry = builtin_entry;
-    dyntracer->probe_builtin_exit = builtin_exit;
-    dyntracer->probe_special_entry = special_entry;
-    dyntracer->probe_special_exit = special_exit;
-    dyntracer->state = state;
-    dyntracer->probe_context_entry = context_entry;
-    dyntracer->probe_context_jump = context_jump;
-    dyntracer->probe_context_exit = context_exit;
+
+    if (state->is_probe_required(Event::EvalEntry)) {
+        dyntracer->probe_eval_entry = eval_entry;
+    }
+
+    if (state->is_probe_required(Event::ClosureEntry)) {
+        dyntracer->probe_closure_entry = closure_entry;
+        dyntracer->probe_closure_exit = closure_exit;
+    }
+
+    if (state->is_probe_required(Event::BuiltinEntry)) {
+        dyntracer->probe_builtin_entry = builtin_entry;
+        dyntracer->probe_builtin_exit = builtin_exit;
+    }
+
+    if (state->is_probe_required(Event::SpecialEntry)) {
+        dyntracer->probe_special_entry = special_entry;
+        dyntracer->probe_special_exit = special_exit;
+    }
+
+    if (state->is_probe_required(Event::ContextEntry)) {
+        dyntracer->probe_context_entry = context_entry;
+        dyntracer->probe_context_jump = context_jump;
+        dyntracer->probe_context_exit = context_exit;
+    }
+
+    if (state->is_probe_required(Event::GcUnmark)) {
+        dyntracer->probe_gc_unmark = gc_unmark;
+    }
+
     return dyntracer_to_sexp(dyntracer, "dyntracer.promise");
 }
 
@@ -49,4 +170,116 @@ SEXP destroy_dyntracer(SEXP dyntracer_sexp) {
     return dyntracer_destroy_sexp(dyntracer_sexp, destroy_promise_dyntracer);
 }
 
+SEXP create_recorder(SEXP output_dirpath, SEXP clock) {
+    Recorder* recorder =
+        new Recorder(sexp_to_string(output_dirpath), sexp_to_clock_type(clock));
+
+    /* calloc initializes the memory to zero. This ensures that probes not
+     attached will be NULL. */
+    dyntracer_t* dyntracer = (dyntracer_t*) calloc(1, sizeof(dyntracer_t));
+    dyntracer->state = recorder;
+
+    /* the log has to capture every event the replayed analyses may need, so
+     all the probes are attached regardless of the analyses. */
+    dyntracer->probe_dyntrace_entry = record_dyntrace_entry;
+    dyntracer->probe_dyntrace_exit = record_dyntrace_exit;
+    dyntracer->probe_eval_entry = record_eval_entry;
+    dyntracer->probe_closure_entry = record_closure_entry;
+    dyntracer->probe_closure_exit = record_closure_exit;
+    dyntracer->probe_builtin_entry = record_builtin_entry;
+    dyntracer->probe_builtin_exit = record_builtin_exit;
+    dyntracer->probe_special_entry = record_special_entry;
+    dyntracer->probe_special_exit = record_special_exit;
+    dyntracer->probe_context_entry = record_context_entry;
+    dyntracer->probe_context_jump = record_context_jump;
+    dyntracer->probe_context_exit = record_context_exit;
+    dyntracer->probe_gc_unmark = record_gc_unmark;
+
+    return dyntracer_to_sexp(dyntracer, "dyntracer.recorder");
+}
+
+static void destroy_recorder_dyntracer(dyntracer_t* dyntracer) {
+    if (dyntracer) {
+        delete (static_cast<Recorder*>(dyntracer->state));
+        free(dyntracer);
+    }
+}
+
+SEXP destroy_recorder(SEXP dyntracer_sexp) {
+    return dyntracer_destroy_sexp(dyntracer_sexp, destroy_recorder_dyntracer);
+}
+
+SEXP replay_event_log(SEXP log_filepath,
+                      SEXP output_dirpath,
+                      SEXP verbose,
+                      SEXP truncate,
+                      SEXP binary,
+                      SEXP compression_level,
+                      SEXP writer_queue_capacity,
+                      SEXP analyses) {
+    TracerState* state = create_replay_state(output_dirpath,
+                                             verbose,
+                                             truncate,
+                                             binary,
+                                             compression_level,
+                                             writer_queue_capacity,
+                                             analyses);
+
+    const std::string filepath = sexp_to_string(log_filepath);
+    std::string error;
+    bool finished = false;
+
+    try {
+        Replayer replayer(filepath, *state);
+        replayer.replay();
+        finished = replayer.is_finished();
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    /* R errors do not unwind C++ frames, so the state is deleted first. */
+    delete state;
+
+    if (!error.empty()) {
+        dyntrace_log_error("%s", error.c_str());
+    } else if (!finished) {
+        dyntrace_log_warning("event log '%s' ends before the end of tracing",
+                             filepath.c_str());
+    }
+
+    return R_NilValue;
+}
+
+SEXP replay_event_logs(SEXP log_filepaths,
+                       SEXP trace_dirpaths,
+                       SEXP output_dirpath,
+                       SEXP verbose,
+                       SEXP truncate,
+                       SEXP binary,
+                       SEXP compression_level,
+                       SEXP writer_queue_capacity,
+                       SEXP analyses,
+                       SEXP thread_count) {
+    TracerState* state = create_replay_state(output_dirpath,
+                                             verbose,
+                                             truncate,
+                                             binary,
+                                             compression_level,
+                                             writer_queue_capacity,
+                                             analyses);
+
+    ParallelReplayer replayer(*state, std::max(sexp_to_int(thread_count), 0));
+
+    for (int i = 0; i < LENGTH(log_filepaths); ++i) {
+        replayer.add_log(CHAR(STRING_ELT(log_filepaths, i)),
+                         CHAR(STRING_ELT(trace_dirpaths, i)));
+    }
+
+    replayer.replay();
+
+    delete state;
+
+    return R_NilValue;
+}
+
 } // extern "C"
@@ -11,10 +11,43 @@ SEXP create_dyntracer(SEXP output_dirpath,
                       SEXP verbose,
                       SEXP truncate,
                       SEXP binary,
-                      SEXP compression_level);
+                      SEXP compression_level,
+                      SEXP writer_queue_capacity,
+                      SEXP analyses,
+                      SEXP clock,
+                      SEXP sampling_rate,
+                      SEXP sampling_unit,
+                      SEXP sampling_seed,
+                      SEXP memory_sampling_interval,
+                      SEXP checkpoint_event_interval,
+                      SEXP checkpoint_time_interval);
 
 SEXP destroy_dyntracer(SEXP dyntracer_sexp);
 
+SEXP create_recorder(SEXP output_dirpath, SEXP clock);
+
+SEXP destroy_recorder(SEXP dyntracer_sexp);
+
+SEXP replay_event_log(SEXP log_filepath,
+                      SEXP output_dirpath,
+                      SEXP verbose,
+                      SEXP truncate,
+                      SEXP binary,
+                      SEXP compression_level,
+                      SEXP writer_queue_capacity,
+                      SEXP analyses);
+
+SEXP replay_event_logs(SEXP log_filepaths,
+                       SEXP trace_dirpaths,
+                       SEXP output_dirpath,
+                       SEXP verbose,
+                       SEXP truncate,
+                       SEXP binary,
+                       SEXP compression_level,
+                       SEXP writer_queue_capacity,
+                       SEXP analyses,
+                       SEXP thread_count);
+
 #ifdef __cplusplus
 }
 #endif
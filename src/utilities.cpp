@@ -1,7 +1,5 @@
 #include "utilities.h"
 
-#include "base64.h"
-
 #include <algorithm>
 
 int get_file_size(std::ifstream& file) {
@@ -86,36 +84,6 @@ std::string serialize_r_expression(SEXP e) {
     return expression;
 }
 
-std::string compute_hash(const char* data) {
-    const EVP_MD* md = EVP_md5();
-    unsigned char md_value[EVP_MAX_MD_SIZE];
-    unsigned int md_len = 0;
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-    EVP_MD_CTX mdctx;
-    EVP_MD_CTX_init(&mdctx);
-    EVP_DigestInit_ex(&mdctx, md, NULL);
-    EVP_DigestUpdate(&mdctx, data, strlen(data));
-    EVP_DigestFinal_ex(&mdctx, md_value, &md_len);
-    EVP_MD_CTX_cleanup(&mdctx);
-#else
-    EVP_MD_CTX* mdctx = EVP_MD_CTX_new();
-    EVP_MD_CTX_init(mdctx);
-    EVP_DigestInit_ex(mdctx, md, NULL);
-    EVP_DigestUpdate(mdctx, data, strlen(data));
-    EVP_DigestFinal_ex(mdctx, md_value, &md_len);
-    EVP_MD_CTX_free(mdctx);
-#endif
-    std::string result{base64_encode(
-        reinterpret_cast<const unsigned char*>(md_value), md_len)};
-
-    // This replacement is done so that the hash can be directly used
-    // as a filename. If this is not done, the / in the hash prevents
-    // it from being used as the name of the file which contains the
-    // function which is hashed.
-    std::replace(result.begin(), result.end(), '/', '#');
-    return result;
-}
-
 const char* remove_null(const char* value) {
     return value ? value : "";
 }
@@ -123,17 +91,3 @@ const char* remove_null(const char* value) {
 std::string to_string(const char* str) {
     return str ? std::string(str) : std::string("");
 }
-
-std::string pos_seq_to_string(const pos_seq_t& pos_seq) {
-    if (pos_seq.size() == 0) {
-        return "()";
-    }
-
-    std::string str = "(" + std::to_string(pos_seq[0]);
-
-    for (auto i = 1; i < pos_seq.size(); ++i) {
-        str.append(" ").append(std::to_string(pos_seq[i]));
-    }
-
-    return str + ")";
-}
@@ -5,7 +5,6 @@
 #include "definitions.h"
 #include "stdlibs.h"
 
-#include <openssl/evp.h>
 #include <type_traits>
 
 char* copy_string(char* destination, const char* source, size_t buffer_size);
@@ -16,8 +15,6 @@ int sexp_to_int(SEXP value);
 
 std::string sexp_to_string(SEXP value);
 
-std::string compute_hash(const char* data);
-
 const char* get_name(SEXP sexp);
 
 std::string serialize_r_expression(SEXP e);
@@ -29,7 +26,20 @@ inline bool timestamp_is_undefined(const timestamp_t timestamp) {
     return timestamp == UNDEFINED_TIMESTAMP;
 }
 
-std::string pos_seq_to_string(const pos_seq_t& pos_seq);
+template <typename Sequence>
+std::string pos_seq_to_string(const Sequence& pos_seq) {
+    if (pos_seq.size() == 0) {
+        return "()";
+    }
+
+    std::string str = "(" + std::to_string(pos_seq[0]);
+
+    for (std::size_t i = 1; i < pos_seq.size(); ++i) {
+        str.append(" ").append(std::to_string(pos_seq[i]));
+    }
+
+    return str + ")";
+}
 
 inline bool is_dots_symbol(const SEXP symbol) {
     return symbol == R_DotsSymbol;
@@ -39,6 +49,12 @@ inline std::string symbol_to_string(const SEXP symbol) {
     return CHAR(PRINTNAME(symbol));
 }
 
+/* a call to function, which creates a closure when it is evaluated. */
+inline bool is_function_definition(const SEXP expression) {
+    return TYPEOF(expression) == LANGSXP && TYPEOF(CAR(expression)) == SYMSXP &&
+           strcmp(CHAR(PRINTNAME(CAR(expression))), "function") == 0;
+}
+
 template <typename T>
 inline void copy_and_reset(T& left, T& right) {
     left = right;